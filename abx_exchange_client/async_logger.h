@@ -0,0 +1,196 @@
+#ifndef ABX_ASYNC_LOGGER_H
+#define ABX_ASYNC_LOGGER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <thread>
+
+const size_t LOG_QUEUE_CAPACITY = 8192;   // must be a power of two
+const size_t LOG_LINE_SIZE = 112;
+const size_t LOG_DIRECT_LINE_SIZE = 1024;   // lines written synchronously, before start() or after stop()
+const int LOG_IDLE_SLEEP_MS = 2;
+const int LOG_SUMMARY_INTERVAL_MS = 1000;
+
+enum class LogLevel : uint8_t {
+    DEBUG,
+    INFO,
+    WARNING,
+    ERROR
+};
+
+// Console logger that keeps stdout off the receive path. Producers format
+// into a fixed-size slot of a bounded lock-free ring and return; a
+// background thread writes the lines out and flushes only when the ring
+// runs dry. When the ring is full the line is dropped and counted rather
+// than blocking the producer. stop() waits for producers that are
+// mid-enqueue before the writer's final pass, so no queued line is lost
+// on shutdown. The writer can also print a once-per-second
+// summary of the messages counted with countMessage().
+class AsyncLogger {
+private:
+    struct Entry {
+        std::atomic<size_t> sequence;
+        LogLevel level;
+        char text[LOG_LINE_SIZE];
+    };
+
+    std::unique_ptr<Entry[]> entries;
+    std::atomic<size_t> enqueuePosition;
+    std::atomic<size_t> writtenPosition;
+    size_t dequeuePosition;   // writer thread only
+
+    std::atomic<LogLevel> minimumLevel;
+    std::atomic<bool> running;
+    std::atomic<bool> finishing;        // every producer is out; the writer makes its last pass
+    std::atomic<int> activeProducers;   // log() calls between the running check and publishing
+    std::atomic<uint64_t> messageCount;
+    std::atomic<uint64_t> droppedCount;
+    bool summaries;
+    std::thread writerThread;
+
+public:
+    AsyncLogger()
+        : entries(new Entry[LOG_QUEUE_CAPACITY]),
+          enqueuePosition(0), writtenPosition(0), dequeuePosition(0),
+          minimumLevel(LogLevel::INFO), running(false), finishing(false), activeProducers(0),
+          messageCount(0), droppedCount(0), summaries(false) {
+        for (size_t i = 0; i < LOG_QUEUE_CAPACITY; ++i) {
+            entries[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~AsyncLogger() { stop(); }
+
+    void setLevel(LogLevel level) { minimumLevel.store(level, std::memory_order_relaxed); }
+
+    bool enabled(LogLevel level) const {
+        return level >= minimumLevel.load(std::memory_order_relaxed);
+    }
+
+    // Starts the writer thread; with printSummaries it also reports the
+    // countMessage() rate once per second
+    void start(bool printSummaries) {
+        if (running.load()) return;
+        summaries = printSummaries;
+        finishing.store(false);
+        running.store(true);
+        writerThread = std::thread(&AsyncLogger::writerLoop, this);
+    }
+
+    // Writes out everything queued and joins the writer. Lines logged after
+    // stop() are written synchronously.
+    void stop() {
+        if (!running.exchange(false)) return;
+        while (activeProducers.load() > 0) std::this_thread::yield();
+        finishing.store(true);
+        writerThread.join();
+    }
+
+    // Blocks until every line queued so far has been written and flushed
+    void drain() const {
+        size_t target = enqueuePosition.load(std::memory_order_acquire);
+        while (running.load() && writtenPosition.load(std::memory_order_acquire) < target) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    void countMessage() { messageCount.fetch_add(1, std::memory_order_relaxed); }
+    uint64_t dropped() const { return droppedCount.load(std::memory_order_relaxed); }
+
+    void log(LogLevel level, const char* format, ...) {
+        if (!enabled(level)) return;
+
+        va_list args;
+        va_start(args, format);
+        activeProducers.fetch_add(1);
+        if (!running.load()) {
+            activeProducers.fetch_sub(1);
+            FILE* stream = streamFor(level);
+            char line[LOG_DIRECT_LINE_SIZE];
+            vsnprintf(line, sizeof(line), format, args);
+            fprintf(stream, "%s\n", line);   // one call, so it cannot split a line being written
+            fflush(stream);
+            va_end(args);
+            return;
+        }
+
+        // Claim a slot (bounded MPMC ring: each slot's sequence says whose turn it is)
+        size_t position = enqueuePosition.load(std::memory_order_relaxed);
+        Entry* entry;
+        for (;;) {
+            entry = &entries[position & (LOG_QUEUE_CAPACITY - 1)];
+            size_t sequence = entry->sequence.load(std::memory_order_acquire);
+            intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+            if (difference == 0) {
+                if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+            } else if (difference < 0) {
+                droppedCount.fetch_add(1, std::memory_order_relaxed);
+                activeProducers.fetch_sub(1, std::memory_order_release);
+                va_end(args);
+                return;
+            } else {
+                position = enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+
+        entry->level = level;
+        vsnprintf(entry->text, LOG_LINE_SIZE, format, args);
+        va_end(args);
+        entry->sequence.store(position + 1, std::memory_order_release);
+        activeProducers.fetch_sub(1, std::memory_order_release);
+    }
+
+private:
+    static FILE* streamFor(LogLevel level) {
+        return level >= LogLevel::WARNING ? stderr : stdout;
+    }
+
+    // Writes every entry that is ready; returns how many were written
+    size_t writeReady() {
+        size_t written = 0;
+        for (;;) {
+            Entry& entry = entries[dequeuePosition & (LOG_QUEUE_CAPACITY - 1)];
+            if (entry.sequence.load(std::memory_order_acquire) != dequeuePosition + 1) break;
+
+            FILE* stream = streamFor(entry.level);
+            fprintf(stream, "%s\n", entry.text);
+            entry.sequence.store(dequeuePosition + LOG_QUEUE_CAPACITY, std::memory_order_release);
+            ++dequeuePosition;
+            ++written;
+        }
+        return written;
+    }
+
+    void writerLoop() {
+        auto lastSummary = std::chrono::steady_clock::now();
+        uint64_t lastCount = messageCount.load(std::memory_order_relaxed);
+
+        for (;;) {
+            bool stopping = finishing.load();
+            if (writeReady() == 0) {
+                fflush(stdout);
+                writtenPosition.store(dequeuePosition, std::memory_order_release);
+                if (stopping) break;
+                std::this_thread::sleep_for(std::chrono::milliseconds(LOG_IDLE_SLEEP_MS));
+            }
+
+            auto now = std::chrono::steady_clock::now();
+            if (summaries && now - lastSummary >= std::chrono::milliseconds(LOG_SUMMARY_INTERVAL_MS)) {
+                uint64_t count = messageCount.load(std::memory_order_relaxed);
+                if (count != lastCount && enabled(LogLevel::INFO)) {
+                    fprintf(stdout, "[INFO] Received %llu messages in the last second (%llu total)\n",
+                            static_cast<unsigned long long>(count - lastCount),
+                            static_cast<unsigned long long>(count));
+                }
+                lastCount = count;
+                lastSummary = now;
+            }
+        }
+    }
+};
+
+#endif // ABX_ASYNC_LOGGER_H
@@ -0,0 +1,74 @@
+#ifndef ABX_BENCH_UTIL_H
+#define ABX_BENCH_UTIL_H
+
+// Timing helpers and synthetic sessions shared by the benchmarks
+
+#include "../wire_protocol.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <vector>
+
+const unsigned BENCH_RANDOM_SEED = 7;
+
+inline double secondsSince(std::chrono::steady_clock::time_point begin) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+inline double nanosecondsPer(std::chrono::steady_clock::time_point begin, size_t operations) {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count() / operations;
+}
+
+// Deterministic message for seq: six symbols, alternating sides, sizes up
+// to six digits and costs up to seven, every third one negative
+inline MarketMessage makeMessage(int32_t seq) {
+    static const char* symbols[] = { "MSFT", "AAPL", "AMZN", "META", "GOOG", "NVDA" };
+    MarketMessage message;
+    memcpy(message.assetCode, symbols[seq % 6], 5);
+    message.orderDirection = (seq & 1) ? 'B' : 'S';
+    message.size = seq * 7 % 100000;
+    message.cost = (seq % 3 == 0) ? -(seq % 9999) : seq * 31 % 2000000;
+    message.sequenceNum = seq;
+    return message;
+}
+
+// Messages for sequences 1..messageCount, in order
+inline std::vector<MarketMessage> makeMessages(size_t messageCount) {
+    std::vector<MarketMessage> messages(messageCount);
+    for (size_t i = 0; i < messageCount; ++i) messages[i] = makeMessage(static_cast<int32_t>(i + 1));
+    return messages;
+}
+
+// Messages for the given sequences, in the same order
+inline std::vector<MarketMessage> makeMessages(const std::vector<int32_t>& sequences) {
+    std::vector<MarketMessage> messages(sequences.size());
+    for (size_t i = 0; i < sequences.size(); ++i) messages[i] = makeMessage(sequences[i]);
+    return messages;
+}
+
+// Sequences 1..messageCount as a lossy stream delivers them: dropRate of
+// them are missing, and every reorderDistance * 16 positions one packet
+// swaps with a neighbour up to reorderDistance away. With resendDropped
+// the missing sequences follow the stream, as recovery would deliver them.
+inline std::vector<int32_t> makeArrivalOrder(size_t messageCount, double dropRate, int reorderDistance,
+                                             bool resendDropped) {
+    std::mt19937 rng(BENCH_RANDOM_SEED);
+    std::uniform_real_distribution<double> dropDice(0.0, 1.0);
+    std::vector<int32_t> streamed, dropped;
+    streamed.reserve(messageCount);
+    for (size_t i = 1; i <= messageCount; ++i) {
+        (dropDice(rng) < dropRate ? dropped : streamed).push_back(static_cast<int32_t>(i));
+    }
+    if (reorderDistance > 0) {
+        size_t distance = static_cast<size_t>(reorderDistance);
+        for (size_t i = 0; i + distance < streamed.size(); i += distance * 16) {
+            std::swap(streamed[i], streamed[i + rng() % distance]);
+        }
+    }
+    if (resendDropped) streamed.insert(streamed.end(), dropped.begin(), dropped.end());
+    return streamed;
+}
+
+#endif // ABX_BENCH_UTIL_H
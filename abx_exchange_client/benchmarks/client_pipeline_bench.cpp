@@ -0,0 +1,158 @@
+// End-to-end client benchmark: MarketDataClient against an in-process
+// MockExchangeServer on loopback. Reports ingest throughput on a lossless
+// stream, recovery time for increasing gap counts, export MB/s and the
+// per-packet latency from socket read to record stored, and recovery time
+// against the number of recovery connections. Results are printed
+// as one JSON object on stdout; the client's own console output is discarded.
+//
+// Build: g++ -std=c++11 -O2 -pthread client_pipeline_bench.cpp -o client_pipeline_bench
+
+#include "../market_data_client.h"
+#include "../../abx_exchange_server/mock_exchange.h"
+#include "bench_util.h"
+
+#include <fcntl.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+const int32_t DEFAULT_PACKET_COUNT = 2000000;
+const char* SCRATCH_OUTPUT_PATH = "client_bench_output.json";
+const double RECOVERY_DROP_RATES[] = { 0.0001, 0.001, 0.01, 0.05 };
+const int RECOVERY_WORKER_COUNTS[] = { 1, 2, 4, 8 };
+const double WORKER_SWEEP_DROP_RATE = 0.05;
+const double WORKER_SWEEP_RESEND_DROP_RATE = 0.3;   // unanswered requests cost a RECOVERY_TIMEOUT_MS wait
+const int32_t WORKER_SWEEP_TIMEOUT_PACKETS = 50000;   // keeps the timeout-bound runs under a minute
+
+struct ScenarioResult {
+    SessionStats stats;
+    double wallSeconds;
+};
+
+// Runs one client session with stdout and stderr pointed at /dev/null
+static ScenarioResult runScenario(const MockExchangeConfig& serverConfig, const ClientOptions& options) {
+    MockExchangeConfig config = serverConfig;
+    config.port = 0;
+    MockExchangeServer server(config);
+    if (!server.start()) {
+        std::cerr << "Could not start the mock exchange" << std::endl;
+        exit(1);
+    }
+
+    fflush(stdout);
+    fflush(stderr);
+    int savedStdout = dup(STDOUT_FILENO);
+    int savedStderr = dup(STDERR_FILENO);
+    int devNull = open("/dev/null", O_WRONLY);
+    dup2(devNull, STDOUT_FILENO);
+    dup2(devNull, STDERR_FILENO);
+
+    ScenarioResult result;
+    auto begin = std::chrono::steady_clock::now();
+    {
+        MarketDataClient client(DEFAULT_HOST_IP, server.port(), options);
+        client.start();
+        result.stats = client.stats();
+    }
+    result.wallSeconds = secondsSince(begin);
+
+    fflush(stdout);
+    fflush(stderr);
+    dup2(savedStdout, STDOUT_FILENO);
+    dup2(savedStderr, STDERR_FILENO);
+    close(savedStdout);
+    close(savedStderr);
+    close(devNull);
+    server.stop();
+    remove(SCRATCH_OUTPUT_PATH);
+    return result;
+}
+
+static std::string latencyJson(const LatencyHistogram& latency) {
+    std::ostringstream out;
+    out << "{\"samples\": " << latency.count()
+        << ", \"p50\": " << latency.percentile(0.50)
+        << ", \"p99\": " << latency.percentile(0.99)
+        << ", \"p999\": " << latency.percentile(0.999)
+        << ", \"max\": " << latency.max() << "}";
+    return out.str();
+}
+
+int main(int argc, char* argv[]) {
+    int32_t packetCount = argc > 1 ? static_cast<int32_t>(strtol(argv[1], NULL, 10)) : DEFAULT_PACKET_COUNT;
+
+    MockExchangeConfig serverConfig;
+    serverConfig.packetCount = packetCount;
+    ClientOptions options;
+    options.measureLatency = true;
+    options.outputPath = SCRATCH_OUTPUT_PATH;
+
+    // Lossless stream: ingest throughput, latency and export rate
+    serverConfig.dropRate = 0.0;
+    ScenarioResult ingest = runScenario(serverConfig, options);
+    const SessionStats& stats = ingest.stats;
+
+    std::cout << "{\n";
+    std::cout << "  \"packets\": " << packetCount << ",\n";
+    std::cout << "  \"ingest\": {\"packets\": " << stats.streamPackets
+              << ", \"seconds\": " << stats.streamSeconds
+              << ", \"msgs_per_sec\": " << stats.streamPackets / stats.streamSeconds
+              << ", \"bytes_per_sec\": " << stats.streamBytes / stats.streamSeconds
+              << ", \"latency_ns\": " << latencyJson(stats.streamLatency) << "},\n";
+    std::cout << "  \"export\": {\"bytes\": " << stats.exportBytes
+              << ", \"seconds\": " << stats.exportSeconds
+              << ", \"mb_per_sec\": " << stats.exportBytes / (1024.0 * 1024.0) / stats.exportSeconds << "},\n";
+
+    // Lossy streams: time from end of stream until every gap is closed
+    std::cout << "  \"recovery\": [";
+    options.measureLatency = false;
+    size_t scenarioCount = sizeof(RECOVERY_DROP_RATES) / sizeof(RECOVERY_DROP_RATES[0]);
+    for (size_t i = 0; i < scenarioCount; ++i) {
+        serverConfig.dropRate = RECOVERY_DROP_RATES[i];
+        ScenarioResult lossy = runScenario(serverConfig, options);
+        std::cout << (i ? ",\n" : "\n")
+                  << "    {\"drop_rate\": " << RECOVERY_DROP_RATES[i]
+                  << ", \"gaps\": " << lossy.stats.gapsOpened
+                  << ", \"missing\": " << lossy.stats.missingCount
+                  << ", \"recovered\": " << lossy.stats.recoveredCount
+                  << ", \"tail_seconds\": " << lossy.stats.recoveryTailSeconds
+                  << ", \"session_seconds\": " << lossy.wallSeconds << "}";
+    }
+    std::cout << "\n  ],\n";
+
+    // Recovery wall time against connection count, for worker threads and
+    // event-loop sessions, with every resend answered and with some ignored
+    std::cout << "  \"recovery_workers\": [";
+    size_t workerCounts = sizeof(RECOVERY_WORKER_COUNTS) / sizeof(RECOVERY_WORKER_COUNTS[0]);
+    bool first = true;
+    for (int timeouts = 0; timeouts < 2; ++timeouts) {
+        serverConfig.dropRate = WORKER_SWEEP_DROP_RATE;
+        serverConfig.resendDropRate = timeouts ? WORKER_SWEEP_RESEND_DROP_RATE : 0.0;
+        serverConfig.packetCount = timeouts ? WORKER_SWEEP_TIMEOUT_PACKETS : packetCount;
+        for (int eventLoop = 0; eventLoop < 2; ++eventLoop) {
+            for (size_t i = 0; i < workerCounts; ++i) {
+                options.eventLoop = eventLoop != 0;
+                options.recoveryConnections = RECOVERY_WORKER_COUNTS[i];
+                ScenarioResult run = runScenario(serverConfig, options);
+                std::cout << (first ? "\n" : ",\n")
+                          << "    {\"mode\": \"" << (eventLoop ? "event_loop" : "threads") << "\""
+                          << ", \"connections\": " << RECOVERY_WORKER_COUNTS[i]
+                          << ", \"packets\": " << serverConfig.packetCount
+                          << ", \"resend_drop_rate\": " << serverConfig.resendDropRate
+                          << ", \"missing\": " << run.stats.missingCount
+                          << ", \"recovered\": " << run.stats.recoveredCount
+                          << ", \"retries\": " << run.stats.recoveryRetries
+                          << ", \"timeouts\": " << run.stats.recoveryTimeouts
+                          << ", \"give_ups\": " << run.stats.recoveryGiveUps
+                          << ", \"tail_seconds\": " << run.stats.recoveryTailSeconds
+                          << ", \"session_seconds\": " << run.wallSeconds << "}";
+                first = false;
+            }
+        }
+    }
+    std::cout << "\n  ]\n}" << std::endl;
+    return 0;
+}
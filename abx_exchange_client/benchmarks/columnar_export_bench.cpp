@@ -0,0 +1,99 @@
+// Export format benchmark: one session of mock-exchange packets (the same
+// symbols, sizes and prices MockExchangeServer streams) written as
+// output.json with JsonWriter and as a columnar file with ColumnarWriter.
+// Reports write speed and bytes per message for both, the encoded size of
+// each column, and the time to decode the columnar file back, which is
+// checked record by record against the input.
+//
+// Build: g++ -std=c++11 -O2 -pthread columnar_export_bench.cpp -o columnar_export_bench
+
+#include "../columnar_file.h"
+#include "../json_writer.h"
+#include "../../abx_exchange_server/mock_exchange.h"
+#include "bench_util.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+const size_t DEFAULT_MESSAGE_COUNT = 5000000;
+const int ROUNDS = 3;
+const char* JSON_PATH = "columnar_bench.json";
+const char* COLUMNAR_PATH = "columnar_bench.col";
+
+int main(int argc, char* argv[]) {
+    size_t messageCount = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_MESSAGE_COUNT;
+
+    MockExchangeConfig config;
+    MockExchangeServer source(config);   // never started; only generates packet content
+    std::vector<MarketMessage> messages(messageCount);
+    for (size_t i = 0; i < messageCount; ++i) messages[i] = source.messageFor(static_cast<int32_t>(i + 1));
+
+    double jsonSeconds = 0, columnarSeconds = 0, readSeconds = 0;
+    uint64_t jsonBytes = 0, columnarBytes = 0;
+    bool identical = true;
+    for (int round = 0; round < ROUNDS; ++round) {
+        auto begin = std::chrono::steady_clock::now();
+        {
+            JsonWriter writer;
+            writer.open(JSON_PATH);
+            writer.beginArray();
+            for (size_t i = 0; i < messages.size(); ++i) writer.writeMessage(messages[i], i + 1 == messages.size());
+            writer.endArray();
+            jsonBytes = writer.bytesWritten();
+            writer.close();
+        }
+        jsonSeconds += secondsSince(begin);
+
+        begin = std::chrono::steady_clock::now();
+        {
+            ColumnarWriter writer;
+            writer.open(COLUMNAR_PATH);
+            for (size_t i = 0; i < messages.size(); ++i) writer.write(messages[i]);
+            identical = writer.close() && identical;
+            columnarBytes = writer.bytesWritten();
+        }
+        columnarSeconds += secondsSince(begin);
+
+        begin = std::chrono::steady_clock::now();
+        ColumnarReader reader;
+        identical = reader.open(COLUMNAR_PATH) && reader.rowCount() == messages.size() && identical;
+        std::vector<MarketMessage> rows;
+        size_t checked = 0;
+        for (size_t g = 0; identical && g < reader.rowGroupCount(); ++g) {
+            identical = reader.readRowGroup(g, rows);
+            for (size_t i = 0; identical && i < rows.size(); ++i, ++checked) {
+                const MarketMessage& expected = messages[checked];
+                identical = memcmp(rows[i].assetCode, expected.assetCode, 5) == 0 &&
+                            rows[i].orderDirection == expected.orderDirection && rows[i].size == expected.size &&
+                            rows[i].cost == expected.cost && rows[i].sequenceNum == expected.sequenceNum;
+            }
+        }
+        readSeconds += secondsSince(begin);
+
+        if (round + 1 == ROUNDS) {
+            double megabyte = 1024.0 * 1024.0;
+            double count = static_cast<double>(messages.size());
+            std::cout << "messages=" << messages.size() << " symbols=" << reader.symbolCount()
+                      << " row_groups=" << reader.rowGroupCount()
+                      << " (round trip identical: " << (identical ? "yes" : "NO") << ")\n";
+            std::cout << "json      " << jsonBytes / count << " bytes/msg  "
+                      << ROUNDS * count / jsonSeconds / 1e6 << " M msg/s  "
+                      << ROUNDS * jsonBytes / megabyte / jsonSeconds << " MB/s\n";
+            std::cout << "columnar  " << columnarBytes / count << " bytes/msg  "
+                      << ROUNDS * count / columnarSeconds / 1e6 << " M msg/s  "
+                      << ROUNDS * columnarBytes / megabyte / columnarSeconds << " MB/s  ("
+                      << double(jsonBytes) / columnarBytes << "x smaller)\n";
+            std::cout << "columns  ";
+            for (int c = 0; c < COLUMNAR_COLUMN_COUNT; ++c) {
+                std::cout << " " << COLUMNAR_SCHEMA[c].name << " " << 8.0 * reader.columnBytes(c) / count << " bits/msg";
+            }
+            std::cout << "\ncolumnar read back  " << ROUNDS * count / readSeconds / 1e6 << " M msg/s" << std::endl;
+        }
+    }
+    remove(JSON_PATH);
+    remove(COLUMNAR_PATH);
+    return identical ? 0 : 1;
+}
@@ -0,0 +1,93 @@
+// Analytic scan benchmark: MessageStore (one padded MarketMessage per slot)
+// vs. ColumnarStore (one array per field). Loads the same session into both,
+// then times a size sum, a size * cost sum and a cost range filter, and
+// compares the answers.
+//
+// Build: g++ -std=c++11 -O2 columnar_store_bench.cpp -o columnar_store_bench
+
+#include "../message_store.h"
+#include "../columnar_store.h"
+#include "bench_util.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+const size_t DEFAULT_MESSAGE_COUNT = 10000000;
+const double DROP_RATE = 0.01;
+const int32_t FILTER_LOW = 1000;
+const int32_t FILTER_HIGH = 50000;
+
+struct ScanTotals {
+    int64_t size;
+    int64_t notional;
+    size_t filtered;
+    double sizeNs, notionalNs, filterNs;
+};
+
+// The same passes written against MarketMessage records
+static ScanTotals scanMessages(const MessageStore& store) {
+    ScanTotals totals = ScanTotals();
+    auto begin = std::chrono::steady_clock::now();
+    store.forEach([&totals](const MarketMessage& message) { totals.size += message.size; });
+    totals.sizeNs = nanosecondsPer(begin, store.size());
+
+    begin = std::chrono::steady_clock::now();
+    store.forEach([&totals](const MarketMessage& message) {
+        totals.notional += static_cast<int64_t>(message.size) * message.cost;
+    });
+    totals.notionalNs = nanosecondsPer(begin, store.size());
+
+    begin = std::chrono::steady_clock::now();
+    store.forEach([&totals](const MarketMessage& message) {
+        totals.filtered += message.cost >= FILTER_LOW && message.cost <= FILTER_HIGH;
+    });
+    totals.filterNs = nanosecondsPer(begin, store.size());
+    return totals;
+}
+
+static ScanTotals scanColumns(const ColumnarStore& store) {
+    ScanTotals totals = ScanTotals();
+    auto begin = std::chrono::steady_clock::now();
+    totals.size = store.totalSize();
+    totals.sizeNs = nanosecondsPer(begin, store.size());
+
+    begin = std::chrono::steady_clock::now();
+    totals.notional = store.totalNotional();
+    totals.notionalNs = nanosecondsPer(begin, store.size());
+
+    begin = std::chrono::steady_clock::now();
+    totals.filtered = store.countCostBetween(FILTER_LOW, FILTER_HIGH);
+    totals.filterNs = nanosecondsPer(begin, store.size());
+    return totals;
+}
+
+static void printRow(const char* name, const ScanTotals& totals, double bytesPerMessage) {
+    std::cout << name << "sum(size)=" << totals.sizeNs << " ns  sum(size*cost)=" << totals.notionalNs
+              << " ns  cost filter=" << totals.filterNs << " ns  bytes/msg=" << bytesPerMessage << "\n";
+}
+
+int main(int argc, char* argv[]) {
+    size_t messageCount = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_MESSAGE_COUNT;
+    std::vector<int32_t> sequences = makeArrivalOrder(messageCount, DROP_RATE, 0, false);
+    MessageStore messageStore;
+    ColumnarStore columnarStore;
+    for (size_t i = 0; i < sequences.size(); ++i) {
+        MarketMessage message = makeMessage(sequences[i]);
+        messageStore.insert(message);
+        columnarStore.insert(message);
+    }
+
+    ScanTotals rows = scanMessages(messageStore);
+    ScanTotals columns = scanColumns(columnarStore);
+    bool agree = rows.size == columns.size && rows.notional == columns.notional && rows.filtered == columns.filtered;
+
+    size_t storedCount = messageStore.size();
+    size_t messageStoreBytes = ((messageStore.highest() / MessageStore::PAGE_MESSAGES) + 1) *
+        MessageStore::PAGE_MESSAGES * sizeof(MarketMessage) + messageStore.sequences().memoryBytes();
+    std::cout << "messages=" << storedCount << " (results agree: " << (agree ? "yes" : "NO") << ")\n";
+    printRow("MessageStore    ", rows, static_cast<double>(messageStoreBytes) / storedCount);
+    printRow("ColumnarStore   ", columns, static_cast<double>(columnarStore.memoryBytes()) / storedCount);
+    std::cout.flush();
+    return agree ? 0 : 1;
+}
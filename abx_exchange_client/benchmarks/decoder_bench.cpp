@@ -0,0 +1,78 @@
+// Batch packet decoder benchmark: per-packet decodePacket vs. each batch
+// decoder this CPU supports, in GB/s of wire data. The packets are decoded
+// in 64 KiB chunks, the size of one full ReceiveBuffer, and every decoder's
+// output is compared with decodePacket.
+//
+// Build: g++ -std=c++11 -O2 decoder_bench.cpp -o decoder_bench
+
+#include "../packet_decoder.h"
+#include "bench_util.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+const size_t DEFAULT_PACKET_COUNT = 1 << 20;
+const int DEFAULT_PASSES = 50;
+const size_t CHUNK_PACKETS = (64 * 1024) / PACKET_SIZE;
+
+static bool sameMessage(const MarketMessage& a, const MarketMessage& b) {
+    return memcmp(a.assetCode, b.assetCode, 5) == 0 && a.orderDirection == b.orderDirection &&
+           a.size == b.size && a.cost == b.cost && a.sequenceNum == b.sequenceNum;
+}
+
+// Runs the decoder over the whole buffer `passes` times; returns GB/s
+static double measure(BatchDecodeFunction decode, const std::vector<uint8_t>& wire,
+                      std::vector<MarketMessage>& messages, int passes) {
+    const size_t packetCount = messages.size();
+    auto begin = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; ++pass) {
+        for (size_t first = 0; first < packetCount; first += CHUNK_PACKETS) {
+            size_t count = std::min(CHUNK_PACKETS, packetCount - first);
+            decode(&wire[first * PACKET_SIZE], count, &messages[first]);
+        }
+    }
+    double seconds = secondsSince(begin);
+    return static_cast<double>(wire.size()) * passes / seconds / 1e9;
+}
+
+int main(int argc, char* argv[]) {
+    size_t packetCount = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_PACKET_COUNT;
+    int passes = argc > 2 ? atoi(argv[2]) : DEFAULT_PASSES;
+
+    std::mt19937 rng(5);
+    std::vector<uint8_t> wire(packetCount * PACKET_SIZE);
+    for (size_t i = 0; i < wire.size(); ++i) wire[i] = static_cast<uint8_t>(rng());
+
+    std::vector<MarketMessage> expected(packetCount);
+    for (size_t i = 0; i < packetCount; ++i) decodePacket(&wire[i * PACKET_SIZE], expected[i]);
+
+    std::vector<BatchDecoder> decoders;
+    BatchDecoder scalar = { "scalar", decodePacketsScalar };
+    decoders.push_back(scalar);
+    #ifdef ABX_X86_SIMD_DECODE
+        if (__builtin_cpu_supports("ssse3")) {
+            BatchDecoder ssse3 = { "ssse3", decodePacketsSsse3 };
+            decoders.push_back(ssse3);
+        }
+    #endif
+
+    std::cout << "packets=" << packetCount << " passes=" << passes
+              << " selected=" << selectedBatchDecoder().name << "\n";
+    bool allMatch = true;
+    for (size_t d = 0; d < decoders.size(); ++d) {
+        std::vector<MarketMessage> messages(packetCount);
+        double rate = measure(decoders[d].decode, wire, messages, passes);
+        bool matches = true;
+        for (size_t i = 0; i < packetCount && matches; ++i) matches = sameMessage(messages[i], expected[i]);
+        allMatch = allMatch && matches;
+        std::cout << decoders[d].name << "\t" << rate << " GB/s  "
+                  << PACKET_SIZE / rate << " ns/packet"
+                  << (matches ? "" : "  MISMATCH") << "\n";
+    }
+    std::cout.flush();
+    return allMatch ? 0 : 1;
+}
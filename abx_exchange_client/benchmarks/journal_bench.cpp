@@ -0,0 +1,93 @@
+// Capture journal benchmark: appends a synthetic session to a CaptureJournal
+// in receive-sized batches (including the final sync), then replays it with
+// JournalReader and checks every record came back. Reports append and
+// replay throughput next to the cost of writing the same session as JSON,
+// the only durable output the client had before the journal.
+//
+// Build: g++ -std=c++11 -O2 -pthread journal_bench.cpp -o journal_bench
+
+#include "../capture_journal.h"
+#include "../json_writer.h"
+#include "bench_util.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+const size_t DEFAULT_MESSAGE_COUNT = 5000000;
+const size_t APPEND_BATCH_MESSAGES = 1024;
+const char* JOURNAL_PATH = "journal_bench.jrnl";
+const char* JSON_PATH = "journal_bench.json";
+
+int main(int argc, char* argv[]) {
+    size_t messageCount = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_MESSAGE_COUNT;
+    std::vector<MarketMessage> messages = makeMessages(messageCount);
+
+    auto begin = std::chrono::steady_clock::now();
+    uint32_t blocks;
+    {
+        CaptureJournal journal;
+        if (!journal.open(JOURNAL_PATH, 0)) {
+            std::cerr << "Could not create " << JOURNAL_PATH << std::endl;
+            return 1;
+        }
+        for (size_t i = 0; i < messages.size(); i += APPEND_BATCH_MESSAGES) {
+            size_t count = std::min(APPEND_BATCH_MESSAGES, messages.size() - i);
+            journal.append(&messages[i], count, static_cast<uint64_t>(i));
+        }
+        journal.close();
+        blocks = journal.blockCount();
+    }
+    double appendSeconds = secondsSince(begin);
+    uint64_t journalBytes = JOURNAL_HEADER_SIZE + uint64_t(blocks) * JOURNAL_BLOCK_SIZE;
+
+    begin = std::chrono::steady_clock::now();
+    size_t replayed = 0;
+    bool intact = true;
+    {
+        JournalReader reader;
+        reader.open(JOURNAL_PATH);
+        std::vector<MarketMessage> batch;
+        size_t count;
+        while ((count = reader.nextBlock(batch)) > 0) {
+            for (size_t i = 0; i < count; ++i, ++replayed) {
+                intact = intact && replayed < messages.size() &&
+                         batch[i].sequenceNum == messages[replayed].sequenceNum &&
+                         batch[i].cost == messages[replayed].cost;
+            }
+        }
+        intact = intact && !reader.endedDamaged() && replayed == messages.size();
+    }
+    double replaySeconds = secondsSince(begin);
+
+    begin = std::chrono::steady_clock::now();
+    size_t jsonBytes;
+    {
+        JsonWriter writer;
+        writer.open(JSON_PATH);
+        writer.beginArray();
+        for (size_t i = 0; i < messages.size(); ++i) writer.writeMessage(messages[i], i + 1 == messages.size());
+        writer.endArray();
+        jsonBytes = writer.bytesWritten();
+        writer.close();
+    }
+    double jsonSeconds = secondsSince(begin);
+
+    remove(JOURNAL_PATH);
+    remove(JSON_PATH);
+
+    double megabyte = 1024.0 * 1024.0;
+    std::cout << "messages=" << messages.size() << " journal_bytes=" << journalBytes
+              << " (" << double(journalBytes) / messages.size() << " per message, replay intact: "
+              << (intact ? "yes" : "NO") << ")\n";
+    std::cout << "journal append  " << messages.size() / appendSeconds / 1e6 << " M msg/s  "
+              << journalBytes / megabyte / appendSeconds << " MB/s\n";
+    std::cout << "journal replay  " << messages.size() / replaySeconds / 1e6 << " M msg/s  "
+              << journalBytes / megabyte / replaySeconds << " MB/s\n";
+    std::cout << "json export     " << messages.size() / jsonSeconds / 1e6 << " M msg/s  "
+              << jsonBytes / megabyte / jsonSeconds << " MB/s (" << double(jsonBytes) / messages.size()
+              << " bytes per message)" << std::endl;
+    return intact ? 0 : 1;
+}
@@ -0,0 +1,82 @@
+// JSON export benchmark: per-message std::stringstream (the original
+// messageToJSON) vs. JsonWriter. Both write the same synthetic session to a
+// scratch file; the files are compared to confirm identical output.
+//
+// Build: g++ -std=c++11 -O2 json_writer_bench.cpp -o json_writer_bench
+
+#include "../json_writer.h"
+#include "bench_util.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+const size_t DEFAULT_MESSAGE_COUNT = 2000000;
+const char* STREAM_OUTPUT_PATH = "json_bench_stringstream.json";
+const char* WRITER_OUTPUT_PATH = "json_bench_writer.json";
+
+// The original MarketDataClient::messageToJSON
+static std::string messageToJSON(const MarketMessage& message, bool isLast) {
+    std::stringstream output;
+    output << "    {\n";
+    output << "        \"assetCode\": \"" << message.assetCode << "\",\n";
+    output << "        \"orderDirection\": \"" << message.orderDirection << "\",\n";
+    output << "        \"size\": " << message.size << ",\n";
+    output << "        \"cost\": " << message.cost << ",\n";
+    output << "        \"sequenceNum\": " << message.sequenceNum << "\n";
+    output << "    }" << (isLast ? "\n" : ",\n");
+    return output.str();
+}
+
+static std::string readFile(const char* path) {
+    std::ifstream in(path, std::ios::binary);
+    std::stringstream contents;
+    contents << in.rdbuf();
+    return contents.str();
+}
+
+int main(int argc, char* argv[]) {
+    size_t messageCount = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_MESSAGE_COUNT;
+    std::vector<MarketMessage> messages = makeMessages(messageCount);
+
+    auto begin = std::chrono::steady_clock::now();
+    {
+        std::ofstream outFile(STREAM_OUTPUT_PATH);
+        outFile << "[\n";
+        for (size_t i = 0; i < messages.size(); ++i) {
+            outFile << messageToJSON(messages[i], i + 1 == messages.size());
+        }
+        outFile << "]" << std::endl;
+    }
+    double streamSeconds = secondsSince(begin);
+
+    begin = std::chrono::steady_clock::now();
+    size_t bytes = 0;
+    {
+        JsonWriter writer;
+        writer.open(WRITER_OUTPUT_PATH);
+        writer.beginArray();
+        for (size_t i = 0; i < messages.size(); ++i) {
+            writer.writeMessage(messages[i], i + 1 == messages.size());
+        }
+        writer.endArray();
+        bytes = writer.bytesWritten();
+        writer.close();
+    }
+    double writerSeconds = secondsSince(begin);
+
+    bool identical = readFile(STREAM_OUTPUT_PATH) == readFile(WRITER_OUTPUT_PATH);
+    remove(STREAM_OUTPUT_PATH);
+    remove(WRITER_OUTPUT_PATH);
+
+    double megabytes = bytes / (1024.0 * 1024.0);
+    std::cout << "messages=" << messages.size() << " bytes=" << bytes
+              << " (identical: " << (identical ? "yes" : "NO") << ")\n";
+    std::cout << "stringstream  " << megabytes / streamSeconds << " MB/s\n";
+    std::cout << "JsonWriter    " << megabytes / writerSeconds << " MB/s" << std::endl;
+    return identical ? 0 : 1;
+}
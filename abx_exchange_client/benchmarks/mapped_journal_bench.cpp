@@ -0,0 +1,173 @@
+// Capture scan benchmark: one journal of a lossy session (stream packets in
+// order, with every gap's packets appended later as resends), scanned four
+// ways with a checksum over every record:
+//   ifstream      - istream::read of each 17-byte packet, then decodePacket
+//   reader        - JournalReader: read() of whole blocks, batch decode
+//   mapped-views  - MappedJournal record views, fields decoded in place
+//   mapped-decode - MappedJournal blocks handed to decodePackets
+// then times random lookups by sequence through the sparse index. The file
+// is scanned once before timing, so every pass reads from the page cache.
+//
+// Build: g++ -std=c++11 -O2 -pthread mapped_journal_bench.cpp -o mapped_journal_bench
+
+#include "../capture_journal.h"
+#include "../mapped_journal.h"
+#include "bench_util.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <vector>
+
+const size_t DEFAULT_MESSAGE_COUNT = 5000000;
+const size_t GAP_EVERY = 100;    // one stream packet in GAP_EVERY arrives late, as a resend
+const size_t LOOKUP_COUNT = 1000000;
+const size_t APPEND_BATCH_MESSAGES = 1024;
+const char* JOURNAL_PATH = "mapped_journal_bench.jrnl";
+
+static bool writeJournal(size_t messageCount) {
+    CaptureJournal journal;
+    if (!journal.open(JOURNAL_PATH, 0)) return false;
+    std::vector<MarketMessage> batch;
+    std::vector<MarketMessage> late;
+    for (size_t seq = 1; seq <= messageCount; ++seq) {
+        (seq % GAP_EVERY == 0 ? late : batch).push_back(makeMessage(static_cast<int32_t>(seq)));
+        if (batch.size() == APPEND_BATCH_MESSAGES) {
+            journal.append(&batch[0], batch.size(), seq);
+            batch.clear();
+        }
+    }
+    if (!batch.empty()) journal.append(&batch[0], batch.size(), messageCount);
+    if (!late.empty()) journal.append(&late[0], late.size(), messageCount + 1);
+    return journal.close();
+}
+
+static int64_t checksum(const MarketMessage& message) {
+    return message.sequenceNum + message.size + static_cast<int64_t>(message.cost) * 3 + message.orderDirection;
+}
+
+struct ScanResult {
+    size_t records;
+    int64_t sum;
+    double seconds;
+};
+
+static ScanResult scanIfstream() {
+    auto begin = std::chrono::steady_clock::now();
+    ScanResult result = { 0, 0, 0 };
+    std::ifstream in(JOURNAL_PATH, std::ios::binary);
+    in.seekg(JOURNAL_HEADER_SIZE);
+    uint8_t header[JOURNAL_BLOCK_HEADER_SIZE];
+    uint8_t packet[PACKET_SIZE];
+    for (uint32_t index = 0; in.read(reinterpret_cast<char*>(header), sizeof(header)); ++index) {
+        uint32_t records = journalBlockRecords(header, index);
+        if (records == 0) break;
+        for (uint32_t i = 0; i < records && in.read(reinterpret_cast<char*>(packet), sizeof(packet)); ++i) {
+            MarketMessage message;
+            decodePacket(packet, message);
+            result.sum += checksum(message);
+            ++result.records;
+        }
+        in.seekg(JOURNAL_HEADER_SIZE + (index + 1) * JOURNAL_BLOCK_SIZE);
+    }
+    result.seconds = secondsSince(begin);
+    return result;
+}
+
+static ScanResult scanReader() {
+    auto begin = std::chrono::steady_clock::now();
+    ScanResult result = { 0, 0, 0 };
+    JournalReader reader;
+    reader.open(JOURNAL_PATH);
+    std::vector<MarketMessage> batch;
+    size_t count;
+    while ((count = reader.nextBlock(batch)) > 0) {
+        for (size_t i = 0; i < count; ++i) result.sum += checksum(batch[i]);
+        result.records += count;
+    }
+    result.seconds = secondsSince(begin);
+    return result;
+}
+
+static ScanResult scanMapped(bool batchDecode) {
+    auto begin = std::chrono::steady_clock::now();
+    ScanResult result = { 0, 0, 0 };
+    MappedJournal journal;
+    journal.open(JOURNAL_PATH);
+    journal.advise(JournalAccess::SEQUENTIAL);
+    std::vector<MarketMessage> batch(JOURNAL_BLOCK_RECORDS);
+    for (size_t b = 0; b < journal.blockCount(); ++b) {
+        JournalBlockView block = journal.block(b);
+        if (batchDecode) {
+            decodePackets(block.packets(), block.size(), &batch[0]);
+            for (size_t i = 0; i < block.size(); ++i) result.sum += checksum(batch[i]);
+        } else {
+            for (size_t i = 0; i < block.size(); ++i) {
+                JournalRecordView record = block.record(i);
+                result.sum += record.sequenceNum() + record.size() + static_cast<int64_t>(record.cost()) * 3 +
+                              record.orderDirection();
+            }
+        }
+        result.records += block.size();
+    }
+    result.seconds = secondsSince(begin);
+    return result;
+}
+
+static void printScan(const char* label, const ScanResult& result, double fileBytes) {
+    std::cout << label << result.records / result.seconds / 1e6 << " M msg/s  "
+              << fileBytes / (1024.0 * 1024.0) / result.seconds << " MB/s\n";
+}
+
+int main(int argc, char* argv[]) {
+    size_t messageCount = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_MESSAGE_COUNT;
+    if (!writeJournal(messageCount)) {
+        std::cerr << "Could not write " << JOURNAL_PATH << std::endl;
+        return 1;
+    }
+
+    scanMapped(true);   // warm the page cache
+    ScanResult scans[4] = { scanIfstream(), scanReader(), scanMapped(false), scanMapped(true) };
+    bool consistent = true;
+    for (int i = 1; i < 4; ++i) {
+        consistent = consistent && scans[i].records == messageCount && scans[i].sum == scans[0].sum;
+    }
+
+    MappedJournal journal;
+    journal.open(JOURNAL_PATH);
+    double fileBytes = static_cast<double>(journal.mappedBytes());
+    journal.advise(JournalAccess::RANDOM);
+
+    auto begin = std::chrono::steady_clock::now();
+    JournalRecordView view;
+    consistent = consistent && journal.findSequence(1, view);   // first lookup builds the index
+    double indexSeconds = secondsSince(begin);
+
+    std::mt19937 random(7);
+    std::uniform_int_distribution<int32_t> pick(1, static_cast<int32_t>(messageCount));
+    begin = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < LOOKUP_COUNT; ++i) {
+        int32_t seq = pick(random);
+        consistent = consistent && journal.findSequence(seq, view) && view.sequenceNum() == seq;
+    }
+    double lookupSeconds = secondsSince(begin);
+    consistent = consistent && !journal.findSequence(static_cast<int32_t>(messageCount) + 1, view);
+    size_t indexBytes = journal.indexBytes();
+    journal.close();
+    remove(JOURNAL_PATH);
+
+    std::cout << "messages=" << messageCount << " file_bytes=" << static_cast<uint64_t>(fileBytes)
+              << " late_records=" << messageCount / GAP_EVERY
+              << " (consistent: " << (consistent ? "yes" : "NO") << ")\n";
+    printScan("ifstream       ", scans[0], fileBytes);
+    printScan("reader         ", scans[1], fileBytes);
+    printScan("mapped-views   ", scans[2], fileBytes);
+    printScan("mapped-decode  ", scans[3], fileBytes);
+    std::cout << "index build    " << indexSeconds * 1e3 << " ms  " << indexBytes / 1024 << " KiB\n";
+    std::cout << "lookups        " << LOOKUP_COUNT / lookupSeconds / 1e6 << " M/s  "
+              << 1e9 * lookupSeconds / LOOKUP_COUNT << " ns each" << std::endl;
+    return consistent ? 0 : 1;
+}
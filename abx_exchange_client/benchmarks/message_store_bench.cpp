@@ -0,0 +1,65 @@
+// Message storage benchmark: the old vector + std::set + std::sort path vs.
+// MessageStore. Simulates a session where 1% of the stream is lost and
+// arrives again through recovery after the stream ends, then walks the
+// messages in sequence order as the export does.
+//
+// Build: g++ -std=c++11 -O2 message_store_bench.cpp -o message_store_bench
+
+#include "../message_store.h"
+#include "bench_util.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <set>
+#include <vector>
+
+const size_t DEFAULT_MESSAGE_COUNT = 10000000;
+const double DROP_RATE = 0.01;
+
+int main(int argc, char* argv[]) {
+    size_t messageCount = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_MESSAGE_COUNT;
+    std::vector<MarketMessage> arrivals = makeMessages(makeArrivalOrder(messageCount, DROP_RATE, 0, true));
+
+    // Old path: append to a vector, track in std::set, sort before export
+    auto begin = std::chrono::steady_clock::now();
+    std::vector<MarketMessage> messageLog;
+    std::set<int> processedSequences;
+    for (size_t i = 0; i < arrivals.size(); ++i) {
+        messageLog.push_back(arrivals[i]);
+        processedSequences.insert(arrivals[i].sequenceNum);
+    }
+    double vectorIngest = secondsSince(begin);
+
+    begin = std::chrono::steady_clock::now();
+    std::sort(messageLog.begin(), messageLog.end(),
+        [](const MarketMessage& a, const MarketMessage& b) {
+            return a.sequenceNum < b.sequenceNum;
+        });
+    int64_t vectorChecksum = 0, position = 0;
+    for (size_t i = 0; i < messageLog.size(); ++i) vectorChecksum += messageLog[i].sequenceNum * ++position;
+    double vectorOrder = secondsSince(begin);
+
+    // MessageStore: direct slots, iteration already in order
+    begin = std::chrono::steady_clock::now();
+    MessageStore store;
+    for (size_t i = 0; i < arrivals.size(); ++i) store.insert(arrivals[i]);
+    double storeIngest = secondsSince(begin);
+
+    begin = std::chrono::steady_clock::now();
+    int64_t storeChecksum = 0;
+    position = 0;
+    store.forEach([&](const MarketMessage& message) {
+        storeChecksum += message.sequenceNum * ++position;
+    });
+    double storeOrder = secondsSince(begin);
+
+    std::cout << "messages=" << arrivals.size()
+              << " (order agrees: " << (vectorChecksum == storeChecksum ? "yes" : "NO") << ")\n";
+    std::cout << "vector+set+sort  ingest=" << vectorIngest << " s  sort+walk=" << vectorOrder
+              << " s  total=" << vectorIngest + vectorOrder << " s\n";
+    std::cout << "MessageStore     ingest=" << storeIngest << " s  walk=" << storeOrder
+              << " s  total=" << storeIngest + storeOrder << " s" << std::endl;
+    return 0;
+}
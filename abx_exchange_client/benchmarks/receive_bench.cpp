@@ -0,0 +1,115 @@
+// Receive path benchmark: per-packet recv() loop vs. bulk ReceiveBuffer.
+// A writer thread pushes synthetic packets through a local socket pair and
+// the reader decodes them with each strategy, counting recv() calls.
+//
+// Build (POSIX): g++ -std=c++11 -O2 -pthread receive_bench.cpp -o receive_bench
+
+#include "../platform.h"
+#include "../wire_protocol.h"
+#include "../receive_buffer.h"
+#include "bench_util.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+const size_t DEFAULT_MESSAGE_COUNT = 2000000;
+const size_t WRITE_CHUNK_PACKETS = 4096;
+
+static void writePackets(int fd, size_t messageCount) {
+    std::vector<uint8_t> chunk(WRITE_CHUNK_PACKETS * PACKET_SIZE);
+    size_t sent = 0;
+    while (sent < messageCount) {
+        size_t batch = std::min(WRITE_CHUNK_PACKETS, messageCount - sent);
+        for (size_t i = 0; i < batch; ++i) {
+            encodePacket(makeMessage(static_cast<int32_t>(sent + i + 1)), &chunk[i * PACKET_SIZE]);
+        }
+        size_t bytes = batch * PACKET_SIZE, offset = 0;
+        while (offset < bytes) {
+            ssize_t n = send(fd, &chunk[offset], bytes - offset, 0);
+            if (n <= 0) return;
+            offset += static_cast<size_t>(n);
+        }
+        sent += batch;
+    }
+    shutdown(fd, SHUT_WR);
+}
+
+struct RunResult {
+    size_t messages;
+    size_t receiveCalls;
+    double seconds;
+    int64_t checksum;
+};
+
+// The original receiveMessage strategy: ask recv() for exactly one packet
+static RunResult runPerPacket(int fd) {
+    RunResult result = { 0, 0, 0, 0 };
+    uint8_t buffer[PACKET_SIZE];
+    MarketMessage message;
+    auto begin = std::chrono::steady_clock::now();
+    for (;;) {
+        size_t total = 0;
+        while (total < PACKET_SIZE) {
+            ssize_t n = recv(fd, buffer + total, PACKET_SIZE - total, 0);
+            ++result.receiveCalls;
+            if (n <= 0) goto done;
+            total += static_cast<size_t>(n);
+        }
+        decodePacket(buffer, message);
+        result.checksum += message.sequenceNum;
+        ++result.messages;
+    }
+done:
+    result.seconds = secondsSince(begin);
+    return result;
+}
+
+static RunResult runBuffered(int fd) {
+    RunResult result = { 0, 0, 0, 0 };
+    ReceiveBuffer receiveBuffer;
+    MarketMessage message;
+    auto begin = std::chrono::steady_clock::now();
+    for (;;) {
+        while (receiveBuffer.nextMessage(message)) {
+            result.checksum += message.sequenceNum;
+            ++result.messages;
+        }
+        if (receiveBuffer.fill(fd) <= 0) break;
+    }
+    result.receiveCalls = receiveBuffer.receiveCallCount();
+    result.seconds = secondsSince(begin);
+    return result;
+}
+
+static RunResult measure(RunResult (*reader)(int), size_t messageCount) {
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+        std::cerr << "socketpair failed: " << errno << std::endl;
+        exit(1);
+    }
+    std::thread writer(writePackets, fds[1], messageCount);
+    RunResult result = reader(fds[0]);
+    writer.join();
+    close(fds[0]);
+    close(fds[1]);
+    return result;
+}
+
+static void printResult(const char* label, const RunResult& result) {
+    std::cout << label
+              << "  messages=" << result.messages
+              << "  recv/msg=" << static_cast<double>(result.receiveCalls) / result.messages
+              << "  msgs/sec=" << static_cast<long long>(result.messages / result.seconds)
+              << "  checksum=" << result.checksum << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    size_t messageCount = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_MESSAGE_COUNT;
+
+    printResult("per-packet recv ", measure(runPerPacket, messageCount));
+    printResult("ReceiveBuffer   ", measure(runBuffered, messageCount));
+    return 0;
+}
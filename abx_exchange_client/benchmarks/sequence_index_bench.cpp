@@ -0,0 +1,73 @@
+// Sequence tracking benchmark: std::set<int> vs. SequenceIndex.
+// Inserts a mostly in-order sequence stream with a configurable fraction of
+// drops and local reordering, then probes every sequence once.
+//
+// Build: g++ -std=c++11 -O2 sequence_index_bench.cpp -o sequence_index_bench
+
+#include "../sequence_index.h"
+#include "bench_util.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <set>
+#include <vector>
+
+const size_t DEFAULT_MESSAGE_COUNT = 10000000;
+const double DROP_RATE = 0.01;
+const int REORDER_DISTANCE = 8;
+
+// Red-black tree node: three pointers, colour, value, plus allocator overhead
+const size_t SET_NODE_BYTES = 48;
+
+int main(int argc, char* argv[]) {
+    size_t messageCount = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_MESSAGE_COUNT;
+    std::vector<int32_t> arrivals = makeArrivalOrder(messageCount, DROP_RATE, REORDER_DISTANCE, false);
+    const int32_t highest = static_cast<int32_t>(messageCount);
+
+    // std::set<int>, as processedSequences used to be
+    std::set<int> tree;
+    auto begin = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < arrivals.size(); ++i) tree.insert(arrivals[i]);
+    double treeInsert = nanosecondsPer(begin, arrivals.size());
+
+    begin = std::chrono::steady_clock::now();
+    size_t treeMissing = 0;
+    for (int32_t seq = 1; seq <= highest; ++seq) treeMissing += tree.find(seq) == tree.end();
+    double treeLookup = nanosecondsPer(begin, messageCount);
+
+    // SequenceIndex
+    SequenceIndex index;
+    begin = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < arrivals.size(); ++i) index.insert(arrivals[i]);
+    double indexInsert = nanosecondsPer(begin, arrivals.size());
+
+    begin = std::chrono::steady_clock::now();
+    size_t indexMissing = 0;
+    for (int32_t seq = 1; seq <= highest; ++seq) indexMissing += !index.contains(seq);
+    double indexLookup = nanosecondsPer(begin, messageCount);
+
+    begin = std::chrono::steady_clock::now();
+    size_t gapSequences = 0;
+    index.forEachGap([&gapSequences](const SequenceRange& gap) {
+        gapSequences += gap.count;
+        return true;
+    });
+    double gapScan = secondsSince(begin) * 1e3;
+
+    // Recovery filling every gap releases the pages again
+    size_t openGapBytes = index.memoryBytes();
+    for (int32_t seq = 1; seq <= highest; ++seq) {
+        if (!index.contains(seq)) index.insert(seq);
+    }
+
+    std::cout << "messages=" << arrivals.size() << " missing=" << indexMissing
+              << " (set agrees: " << (treeMissing == indexMissing && gapSequences == indexMissing ? "yes" : "NO") << ")\n";
+    std::cout << "std::set<int>   insert=" << treeInsert << " ns  contains=" << treeLookup
+              << " ns  bits/msg=" << (tree.size() * SET_NODE_BYTES * 8.0) / arrivals.size() << "\n";
+    std::cout << "SequenceIndex   insert=" << indexInsert << " ns  contains=" << indexLookup
+              << " ns  bits/msg=" << (openGapBytes * 8.0) / arrivals.size()
+              << " (" << (index.memoryBytes() * 8.0) / index.size() << " once gaps are filled)"
+              << "  gap scan=" << gapScan << " ms" << std::endl;
+    return 0;
+}
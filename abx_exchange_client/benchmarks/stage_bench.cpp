@@ -0,0 +1,198 @@
+// Per-stage microbenchmarks over one synthetic in-memory session, no
+// sockets involved. Each client stage is timed in its original form and
+// in its current form, in ns per message:
+//   decode    17-byte packet parse (ntohl on the raw buffer vs. decodePacket)
+//   sequence  duplicate/gap tracking (std::set<int> vs. SequenceIndex)
+//   order     sequence ordering for export (std::sort vs. MessageStore)
+//   json      record formatting (stringstream vs. JsonWriter), to /dev/null
+//   aggregate per-symbol totals (std::map<std::string> vs. SymbolAggregator)
+// Results are printed as one JSON object so runs can be compared.
+//
+// Build: g++ -std=c++11 -O2 stage_bench.cpp -o stage_bench
+
+#include "../platform.h"
+#include "../message_store.h"
+#include "../json_writer.h"
+#include "../symbol_aggregator.h"
+#include "bench_util.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <vector>
+
+const size_t DEFAULT_MESSAGE_COUNT = 5000000;
+const double DROP_RATE = 0.01;
+const int REORDER_DISTANCE = 8;
+const char* NULL_DEVICE = "/dev/null";
+
+struct StageResult {
+    const char* stage;
+    double originalNs;
+    double currentNs;
+};
+
+// Wire bytes of a session in arrival order: 1% of packets are held back
+// and appended at the end as recovery would deliver them, with some local
+// reordering in between.
+static std::vector<uint8_t> makeWireSession(size_t messageCount) {
+    std::vector<MarketMessage> arrivals = makeMessages(makeArrivalOrder(messageCount, DROP_RATE, REORDER_DISTANCE, true));
+    std::vector<uint8_t> wire(arrivals.size() * PACKET_SIZE);
+    for (size_t i = 0; i < arrivals.size(); ++i) encodePacket(arrivals[i], &wire[i * PACKET_SIZE]);
+    return wire;
+}
+
+// The original receiveMessage parse; memcpy stands in for the unaligned
+// reinterpret_cast and compiles to the same load.
+static void decodeWithNtohl(const uint8_t* buffer, MarketMessage& message) {
+    uint32_t field;
+    memcpy(message.assetCode, buffer, 4);
+    message.assetCode[4] = '\0';
+    message.orderDirection = static_cast<char>(buffer[4]);
+    memcpy(&field, buffer + 5, 4);
+    message.size = static_cast<int32_t>(ntohl(field));
+    memcpy(&field, buffer + 9, 4);
+    message.cost = static_cast<int32_t>(ntohl(field));
+    memcpy(&field, buffer + 13, 4);
+    message.sequenceNum = static_cast<int32_t>(ntohl(field));
+}
+
+// The original MarketDataClient::messageToJSON
+static std::string messageToJSON(const MarketMessage& message, bool isLast) {
+    std::stringstream output;
+    output << "    {\n";
+    output << "        \"assetCode\": \"" << message.assetCode << "\",\n";
+    output << "        \"orderDirection\": \"" << message.orderDirection << "\",\n";
+    output << "        \"size\": " << message.size << ",\n";
+    output << "        \"cost\": " << message.cost << ",\n";
+    output << "        \"sequenceNum\": " << message.sequenceNum << "\n";
+    output << "    }" << (isLast ? "\n" : ",\n");
+    return output.str();
+}
+
+int main(int argc, char* argv[]) {
+    size_t messageCount = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_MESSAGE_COUNT;
+    std::vector<uint8_t> wire = makeWireSession(messageCount);
+    const size_t packetCount = wire.size() / PACKET_SIZE;
+    std::vector<StageResult> results;
+    uint64_t checksum = 0;
+
+    // decode
+    std::vector<MarketMessage> arrivals(packetCount);
+    auto begin = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < packetCount; ++i) decodeWithNtohl(&wire[i * PACKET_SIZE], arrivals[i]);
+    double originalNs = nanosecondsPer(begin, packetCount);
+    for (size_t i = 0; i < packetCount; ++i) checksum += static_cast<uint32_t>(arrivals[i].cost);
+
+    begin = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < packetCount; ++i) decodePacket(&wire[i * PACKET_SIZE], arrivals[i]);
+    StageResult decode = { "decode", originalNs, nanosecondsPer(begin, packetCount) };
+    results.push_back(decode);
+    for (size_t i = 0; i < packetCount; ++i) checksum -= static_cast<uint32_t>(arrivals[i].cost);
+
+    // sequence
+    {
+        std::set<int> processedSequences;
+        begin = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < packetCount; ++i) processedSequences.insert(arrivals[i].sequenceNum);
+        originalNs = nanosecondsPer(begin, packetCount);
+        checksum += processedSequences.size();
+    }
+    {
+        SequenceIndex index;
+        begin = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < packetCount; ++i) index.insert(arrivals[i].sequenceNum);
+        StageResult sequence = { "sequence", originalNs, nanosecondsPer(begin, packetCount) };
+        results.push_back(sequence);
+        checksum -= index.size();
+    }
+
+    // order
+    std::vector<MarketMessage> ordered;
+    {
+        std::vector<MarketMessage> messageLog(arrivals);
+        begin = std::chrono::steady_clock::now();
+        std::sort(messageLog.begin(), messageLog.end(),
+            [](const MarketMessage& a, const MarketMessage& b) { return a.sequenceNum < b.sequenceNum; });
+        originalNs = nanosecondsPer(begin, packetCount);
+        ordered.swap(messageLog);
+    }
+    {
+        MessageStore store;
+        begin = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < packetCount; ++i) store.insert(arrivals[i]);
+        int32_t previous = 0;
+        bool inOrder = true;
+        store.forEach([&](const MarketMessage& message) {
+            inOrder = inOrder && message.sequenceNum > previous;
+            previous = message.sequenceNum;
+        });
+        StageResult order = { "order", originalNs, nanosecondsPer(begin, packetCount) };
+        results.push_back(order);
+        if (!inOrder || store.size() != ordered.size()) checksum++;
+    }
+
+    // json
+    {
+        std::ofstream outFile(NULL_DEVICE);
+        begin = std::chrono::steady_clock::now();
+        outFile << "[\n";
+        for (size_t i = 0; i < ordered.size(); ++i) {
+            outFile << messageToJSON(ordered[i], i + 1 == ordered.size());
+        }
+        outFile << "]" << std::endl;
+        originalNs = nanosecondsPer(begin, ordered.size());
+    }
+    {
+        JsonWriter writer;
+        writer.open(NULL_DEVICE);
+        begin = std::chrono::steady_clock::now();
+        writer.beginArray();
+        for (size_t i = 0; i < ordered.size(); ++i) {
+            writer.writeMessage(ordered[i], i + 1 == ordered.size());
+        }
+        writer.endArray();
+        writer.close();
+        StageResult json = { "json", originalNs, nanosecondsPer(begin, ordered.size()) };
+        results.push_back(json);
+    }
+
+    // aggregate
+    {
+        std::map<std::string, SymbolTotals> totalsByCode;
+        begin = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < packetCount; ++i) {
+            SymbolTotals& totals = totalsByCode[arrivals[i].assetCode];
+            totals.volume += arrivals[i].size;
+            totals.notional += static_cast<int64_t>(arrivals[i].size) * arrivals[i].cost;
+            if (arrivals[i].orderDirection == 'B') totals.buyVolume += arrivals[i].size;
+            else totals.sellVolume += arrivals[i].size;
+        }
+        originalNs = nanosecondsPer(begin, packetCount);
+        for (std::map<std::string, SymbolTotals>::iterator it = totalsByCode.begin(); it != totalsByCode.end(); ++it) {
+            checksum += static_cast<uint64_t>(it->second.notional);
+        }
+
+        SymbolAggregator aggregator;
+        begin = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < packetCount; ++i) aggregator.update(arrivals[i]);
+        StageResult aggregate = { "aggregate", originalNs, nanosecondsPer(begin, packetCount) };
+        results.push_back(aggregate);
+        std::vector<SymbolTotals> snapshot = aggregator.snapshot();
+        for (size_t i = 0; i < snapshot.size(); ++i) checksum -= static_cast<uint64_t>(snapshot[i].notional);
+    }
+
+    std::cout << "{\n  \"messages\": " << packetCount << ",\n  \"consistent\": "
+              << (checksum == 0 ? "true" : "false") << ",\n  \"stages_ns_per_msg\": {";
+    for (size_t i = 0; i < results.size(); ++i) {
+        std::cout << (i ? ",\n" : "\n") << "    \"" << results[i].stage << "\": {\"original\": "
+                  << results[i].originalNs << ", \"current\": " << results[i].currentNs << "}";
+    }
+    std::cout << "\n  }\n}" << std::endl;
+    return checksum == 0 ? 0 : 1;
+}
@@ -0,0 +1,65 @@
+// Symbol lookup benchmark: std::unordered_map<std::string, uint32_t> keyed
+// by the NUL-terminated assetCode vs. SymbolTable keyed by the raw 4 bytes.
+// Both intern the same stream of codes drawn from a fixed symbol universe
+// and must hand out the same ids.
+//
+// Build: g++ -std=c++11 -O2 symbol_table_bench.cpp -o symbol_table_bench
+
+#include "../symbol_table.h"
+#include "../wire_protocol.h"
+#include "bench_util.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+const size_t DEFAULT_MESSAGE_COUNT = 10000000;
+const size_t SYMBOL_UNIVERSES[] = { 16, 512, 8192 };
+
+int main(int argc, char* argv[]) {
+    size_t messageCount = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_MESSAGE_COUNT;
+    bool allAgree = true;
+
+    for (size_t u = 0; u < sizeof(SYMBOL_UNIVERSES) / sizeof(SYMBOL_UNIVERSES[0]); ++u) {
+        size_t universe = SYMBOL_UNIVERSES[u];
+        std::mt19937 rng(static_cast<unsigned>(universe));
+        std::vector<MarketMessage> messages(messageCount);
+        for (size_t i = 0; i < messageCount; ++i) {
+            uint32_t symbol = rng() % universe;
+            for (int c = 0; c < 4; ++c) {
+                messages[i].assetCode[c] = static_cast<char>('A' + symbol % 26);
+                symbol /= 26;
+            }
+            messages[i].assetCode[4] = '\0';
+        }
+
+        std::vector<uint32_t> mapIds(messageCount), tableIds(messageCount);
+        std::unordered_map<std::string, uint32_t> symbolMap;
+        auto begin = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < messageCount; ++i) {
+            std::unordered_map<std::string, uint32_t>::iterator it = symbolMap.find(messages[i].assetCode);
+            if (it == symbolMap.end()) {
+                it = symbolMap.insert(std::make_pair(std::string(messages[i].assetCode),
+                                                     static_cast<uint32_t>(symbolMap.size() + 1))).first;
+            }
+            mapIds[i] = it->second;
+        }
+        double mapNs = nanosecondsPer(begin, messageCount);
+
+        SymbolTable table;
+        begin = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < messageCount; ++i) tableIds[i] = table.intern(messages[i].assetCode);
+        double tableNs = nanosecondsPer(begin, messageCount);
+
+        bool agree = mapIds == tableIds;
+        allAgree = allAgree && agree;
+        std::cout << "symbols=" << table.size() << "\tunordered_map<string> " << mapNs
+                  << " ns  SymbolTable " << tableNs << " ns  (ids agree: " << (agree ? "yes" : "NO") << ")\n";
+    }
+    std::cout.flush();
+    return allAgree ? 0 : 1;
+}
@@ -0,0 +1,114 @@
+// Stream receive benchmark: ExchangeConnection reading a lossless stream from
+// an in-process MockExchangeServer on loopback, once with plain recv() and
+// once through the io_uring multishot receiver. Reports receive syscalls per
+// message and the reader thread's CPU use (user + system time over wall
+// time, from getrusage) as one JSON object on stdout. The io_uring entry is
+// omitted when the kernel does not support it.
+//
+// Build (Linux): g++ -std=c++11 -O2 -pthread uring_receive_bench.cpp -o uring_receive_bench
+
+#include "../exchange_connection.h"
+#include "../../abx_exchange_server/mock_exchange.h"
+#include "bench_util.h"
+
+#include <sys/resource.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+const int32_t DEFAULT_PACKET_COUNT = 5000000;
+const int ROUNDS = 3;
+const size_t READ_BATCH_MESSAGES = 1024;
+
+struct RunResult {
+    bool ran;
+    uint64_t messages;
+    uint64_t syscalls;
+    double seconds;
+    double cpuSeconds;
+    int64_t checksum;
+};
+
+static double threadCpuSeconds() {
+    struct rusage usage;
+    getrusage(RUSAGE_THREAD, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+           (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+// Reads one full stream; the mock serves each connection on its own thread,
+// so the CPU time measured here is the reader's alone
+static RunResult readStream(int port, bool uring) {
+    RunResult result = { false, 0, 0, 0, 0, 0 };
+    ExchangeConnection connection;
+    if (!connection.connect("127.0.0.1", port)) exit(1);
+    if (uring && !connection.useUring()) return result;
+
+    std::vector<uint8_t> request;
+    appendCommand(request, CommandType::INITIAL_STREAM);
+    std::vector<MarketMessage> batch(READ_BATCH_MESSAGES);
+
+    auto begin = std::chrono::steady_clock::now();
+    double cpuBegin = threadCpuSeconds();
+    connection.send(request);
+    size_t count;
+    while (connection.receive(&batch[0], batch.size(), count) == ReceiveStatus::MESSAGES) {
+        for (size_t i = 0; i < count; ++i) result.checksum += batch[i].sequenceNum;
+        result.messages += count;
+    }
+    result.cpuSeconds = threadCpuSeconds() - cpuBegin;
+    result.seconds = secondsSince(begin);
+    result.syscalls = connection.receiveSyscallCount();
+    result.ran = true;
+    return result;
+}
+
+static void printResult(const char* label, const RunResult& total) {
+    std::cout << "    \"" << label << "\": {\"messages\": " << total.messages
+              << ", \"syscalls_per_msg\": " << double(total.syscalls) / total.messages
+              << ", \"msgs_per_sec\": " << total.messages / total.seconds
+              << ", \"cpu_percent\": " << 100.0 * total.cpuSeconds / total.seconds
+              << ", \"cpu_ns_per_msg\": " << 1e9 * total.cpuSeconds / total.messages
+              << ", \"checksum\": " << total.checksum << "}";
+}
+
+int main(int argc, char* argv[]) {
+    int32_t packetCount = argc > 1 ? static_cast<int32_t>(strtol(argv[1], NULL, 10)) : DEFAULT_PACKET_COUNT;
+
+    MockExchangeConfig config;
+    config.port = 0;
+    config.packetCount = packetCount;
+    config.dropRate = 0.0;
+    MockExchangeServer server(config);
+    if (!server.start()) {
+        std::cerr << "Could not start the mock exchange" << std::endl;
+        return 1;
+    }
+
+    // Alternate the backends so both see the same machine conditions
+    RunResult totals[2] = { { true, 0, 0, 0, 0, 0 }, { true, 0, 0, 0, 0, 0 } };
+    for (int round = 0; round < ROUNDS; ++round) {
+        for (int backend = 0; backend < 2; ++backend) {
+            RunResult run = readStream(server.port(), backend == 1);
+            RunResult& total = totals[backend];
+            total.ran = total.ran && run.ran;
+            total.messages += run.messages;
+            total.syscalls += run.syscalls;
+            total.seconds += run.seconds;
+            total.cpuSeconds += run.cpuSeconds;
+            total.checksum += run.checksum;
+        }
+    }
+    server.stop();
+
+    std::cout << "{\n  \"packets\": " << packetCount << ",\n  \"rounds\": " << ROUNDS << ",\n  \"results\": {\n";
+    printResult("recv", totals[0]);
+    if (totals[1].ran) {
+        std::cout << ",\n";
+        printResult("io_uring", totals[1]);
+    }
+    std::cout << "\n  }\n}" << std::endl;
+    return 0;
+}
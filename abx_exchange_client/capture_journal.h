@@ -0,0 +1,382 @@
+#ifndef ABX_CAPTURE_JOURNAL_H
+#define ABX_CAPTURE_JOURNAL_H
+
+#include "wire_protocol.h"
+#include "packet_decoder.h"
+
+#include <errno.h>
+#include <fcntl.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+    #include <io.h>
+    #define journal_open ::_open
+    #define journal_read ::_read
+    #define journal_write ::_write
+    #define journal_close ::_close
+    #define journal_sync ::_commit
+    const int JOURNAL_WRITE_FLAGS = _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY;
+    const int JOURNAL_READ_FLAGS = _O_RDONLY | _O_BINARY;
+#else
+    #include <unistd.h>
+    #define journal_open ::open
+    #define journal_read ::read
+    #define journal_write ::write
+    #define journal_close ::close
+    #if defined(__linux__)
+        #define journal_sync ::fdatasync
+    #else
+        #define journal_sync ::fsync
+    #endif
+    const int JOURNAL_WRITE_FLAGS = O_WRONLY | O_CREAT | O_TRUNC;
+    const int JOURNAL_READ_FLAGS = O_RDONLY;
+#endif
+
+// On-disk layout. All integers are little-endian except the packets, which
+// are stored exactly as they came off the wire.
+//
+//   file header   JOURNAL_HEADER_SIZE bytes: magic, version, block size,
+//                 records per block, creation time
+//   block 0..n    JOURNAL_BLOCK_SIZE bytes each, at aligned offsets:
+//                 [magic u32][block index u32][record count u32][checksum u32]
+//                 [packets: JOURNAL_BLOCK_RECORDS x 17 bytes]
+//                 [receive timestamps: JOURNAL_BLOCK_RECORDS x u64 ns since epoch]
+//
+// Packets and timestamps are kept in separate runs so replay can hand a
+// block's packets to the batch decoder as they are. Unused slots are zero.
+const char JOURNAL_FILE_MAGIC[8] = { 'A', 'B', 'X', 'J', 'R', 'N', 'L', '1' };
+const uint32_t JOURNAL_BLOCK_MAGIC = 0x42584241;   // "ABXB"
+const uint32_t JOURNAL_VERSION = 1;
+const size_t JOURNAL_HEADER_SIZE = 4096;
+const size_t JOURNAL_BLOCK_SIZE = 64 * 1024;
+const size_t JOURNAL_BLOCK_HEADER_SIZE = 16;
+const size_t JOURNAL_RECORD_SIZE = PACKET_SIZE + 8;
+const size_t JOURNAL_BLOCK_RECORDS = (JOURNAL_BLOCK_SIZE - JOURNAL_BLOCK_HEADER_SIZE) / JOURNAL_RECORD_SIZE;
+const size_t JOURNAL_TIMESTAMPS_OFFSET = JOURNAL_BLOCK_HEADER_SIZE + JOURNAL_BLOCK_RECORDS * PACKET_SIZE;
+const int JOURNAL_CHECKPOINT_MS = 1000;       // longest time a record stays unsynced
+const size_t JOURNAL_MAX_QUEUED_BLOCKS = 64;  // writer backlog before appends wait
+
+// Detects torn and partially written blocks; not a cryptographic hash.
+// Mixes eight bytes per step so replay is not held back by it.
+inline uint32_t journalChecksum(const uint8_t* bytes, size_t length) {
+    uint64_t hash = 0x243F6A8885A308D3ULL ^ length;
+    size_t offset = 0;
+    for (; offset + 8 <= length; offset += 8) {
+        uint64_t word;
+        memcpy(&word, bytes + offset, 8);
+        hash = (hash ^ word) * 0x9E3779B97F4A7C15ULL;
+        hash ^= hash >> 32;
+    }
+    for (; offset < length; ++offset) hash = (hash ^ bytes[offset]) * 0x100000001B3ULL;
+    return static_cast<uint32_t>(hash ^ (hash >> 29));
+}
+
+// Checksum over a block's index and count fields and its used record slots
+inline uint32_t journalBlockChecksum(const uint8_t* block, size_t records) {
+    uint32_t hash = journalChecksum(block + 4, 8);
+    hash ^= journalChecksum(block + JOURNAL_BLOCK_HEADER_SIZE, records * PACKET_SIZE) * 31;
+    hash ^= journalChecksum(block + JOURNAL_TIMESTAMPS_OFFSET, records * 8) * 131;
+    return hash;
+}
+
+// True when a file header was written by this version of CaptureJournal
+inline bool journalHeaderValid(const uint8_t* header) {
+    return memcmp(header, JOURNAL_FILE_MAGIC, sizeof(JOURNAL_FILE_MAGIC)) == 0 &&
+           readUInt32LE(header + 8) == JOURNAL_VERSION &&
+           readUInt32LE(header + 12) == JOURNAL_BLOCK_SIZE &&
+           readUInt32LE(header + 16) == JOURNAL_BLOCK_RECORDS;
+}
+
+// Record count of a block whose header is well formed and carries the
+// expected index, or 0. The checksum is left to the caller.
+inline uint32_t journalBlockRecords(const uint8_t* block, uint32_t expectedIndex) {
+    uint32_t records = readUInt32LE(block + 8);
+    if (readUInt32LE(block) != JOURNAL_BLOCK_MAGIC || readUInt32LE(block + 4) != expectedIndex ||
+        records > JOURNAL_BLOCK_RECORDS) {
+        return 0;
+    }
+    return records;
+}
+
+// Append-only capture of every packet the client processes, with its
+// receive time. Appends fill an in-memory block; full blocks are handed to
+// a writer thread that writes them sequentially at block-aligned offsets.
+// At least every JOURNAL_CHECKPOINT_MS the writer seals the current block,
+// even if partly filled, and syncs the file, so a crash loses at most that
+// much data (plus the bounded queue of blocks waiting to be written) and
+// never corrupts what was synced. The deadline is checked whether or not
+// the writer is idle, so a busy feed is synced too. Safe to append from
+// several threads.
+class CaptureJournal {
+private:
+    struct SealedBlock {
+        std::vector<uint8_t> bytes;
+        bool checkpoint;
+    };
+
+    int fileDescriptor;
+    std::mutex mutex;
+    std::condition_variable writerWake;
+    std::condition_variable spaceAvailable;
+    std::vector<uint8_t> current;
+    size_t currentRecords;
+    uint32_t nextBlockIndex;
+    std::deque<SealedBlock> sealed;
+    std::chrono::steady_clock::time_point lastCheckpoint;
+    bool stopping;
+    bool failed;
+    uint64_t recordTotal;
+    uint64_t checkpointTotal;
+    std::thread writerThread;
+
+public:
+    CaptureJournal()
+        : fileDescriptor(-1), currentRecords(0), nextBlockIndex(0), stopping(false), failed(false),
+          recordTotal(0), checkpointTotal(0) {}
+
+    CaptureJournal(const CaptureJournal&) = delete;
+    CaptureJournal& operator=(const CaptureJournal&) = delete;
+    ~CaptureJournal() { close(); }
+
+    // Creates (or truncates) the journal and starts the writer thread
+    bool open(const char* path, uint64_t createdAtNs) {
+        close();
+        fileDescriptor = journal_open(path, JOURNAL_WRITE_FLAGS, 0644);
+        if (fileDescriptor < 0) return false;
+
+        std::vector<uint8_t> header(JOURNAL_HEADER_SIZE, 0);
+        memcpy(&header[0], JOURNAL_FILE_MAGIC, sizeof(JOURNAL_FILE_MAGIC));
+        writeUInt32LE(&header[8], JOURNAL_VERSION);
+        writeUInt32LE(&header[12], static_cast<uint32_t>(JOURNAL_BLOCK_SIZE));
+        writeUInt32LE(&header[16], static_cast<uint32_t>(JOURNAL_BLOCK_RECORDS));
+        writeUInt64LE(&header[20], createdAtNs);
+        if (!writeAll(header) || journal_sync(fileDescriptor) != 0) {
+            journal_close(fileDescriptor);
+            fileDescriptor = -1;
+            return false;
+        }
+
+        current.assign(JOURNAL_BLOCK_SIZE, 0);
+        currentRecords = 0;
+        nextBlockIndex = 0;
+        stopping = false;
+        failed = false;
+        recordTotal = 0;
+        checkpointTotal = 0;
+        lastCheckpoint = std::chrono::steady_clock::now();
+        writerThread = std::thread(&CaptureJournal::writerLoop, this);
+        return true;
+    }
+
+    bool isOpen() const { return fileDescriptor >= 0; }
+
+    // Appends count messages received at the same time
+    void append(const MarketMessage* messages, size_t count, uint64_t receivedAtNs) {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (size_t i = 0; i < count; ++i) appendRecord(lock, messages[i], receivedAtNs);
+    }
+
+    // Appends count messages, each with its own receive time
+    void append(const MarketMessage* messages, const uint64_t* receivedAtNs, size_t count) {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (size_t i = 0; i < count; ++i) appendRecord(lock, messages[i], receivedAtNs[i]);
+    }
+
+    // Seals what is buffered, waits for it to reach the disk and closes the
+    // file. Returns false if any write or sync failed.
+    bool close() {
+        if (fileDescriptor < 0) return true;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            sealCurrent(true);
+            stopping = true;
+        }
+        writerWake.notify_one();
+        writerThread.join();
+        journal_close(fileDescriptor);
+        fileDescriptor = -1;
+        return !failed;
+    }
+
+    uint64_t recordCount() const { return recordTotal; }
+    uint64_t checkpointCount() const { return checkpointTotal; }
+    uint32_t blockCount() const { return nextBlockIndex; }
+
+private:
+    void appendRecord(std::unique_lock<std::mutex>& lock, const MarketMessage& message, uint64_t receivedAtNs) {
+        encodePacket(message, &current[JOURNAL_BLOCK_HEADER_SIZE + currentRecords * PACKET_SIZE]);
+        writeUInt64LE(&current[JOURNAL_TIMESTAMPS_OFFSET + currentRecords * 8], receivedAtNs);
+        ++currentRecords;
+        ++recordTotal;
+        if (currentRecords == JOURNAL_BLOCK_RECORDS) {
+            // Back-pressure instead of unbounded memory when the disk falls behind
+            while (sealed.size() >= JOURNAL_MAX_QUEUED_BLOCKS && !failed) spaceAvailable.wait(lock);
+            sealCurrent(false);
+        }
+    }
+
+    // Finishes the block header and queues the block; mutex must be held.
+    // A checkpoint with nothing buffered still queues a sync.
+    void sealCurrent(bool checkpoint) {
+        sealed.push_back(SealedBlock());
+        sealed.back().checkpoint = checkpoint;
+        if (currentRecords > 0) {
+            writeUInt32LE(&current[0], JOURNAL_BLOCK_MAGIC);
+            writeUInt32LE(&current[4], nextBlockIndex++);
+            writeUInt32LE(&current[8], static_cast<uint32_t>(currentRecords));
+            writeUInt32LE(&current[12], journalBlockChecksum(&current[0], currentRecords));
+            sealed.back().bytes.swap(current);
+            current.assign(JOURNAL_BLOCK_SIZE, 0);
+            currentRecords = 0;
+        }
+        if (checkpoint) lastCheckpoint = std::chrono::steady_clock::now();
+        writerWake.notify_one();
+    }
+
+    void writerLoop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            if (sealed.empty()) {
+                if (stopping) return;
+                auto checkpointDue = lastCheckpoint + std::chrono::milliseconds(JOURNAL_CHECKPOINT_MS);
+                if (writerWake.wait_until(lock, checkpointDue) == std::cv_status::timeout &&
+                    sealed.empty() && currentRecords > 0) {
+                    sealCurrent(true);
+                }
+                continue;
+            }
+
+            SealedBlock block;
+            block.bytes.swap(sealed.front().bytes);
+            block.checkpoint = sealed.front().checkpoint;
+            sealed.pop_front();
+            spaceAvailable.notify_all();
+
+            // Under load the queue never runs dry, so a checkpoint that falls
+            // due is taken here: the file is synced after this block, and the
+            // partial block is sealed behind the queued ones with its own sync
+            auto now = std::chrono::steady_clock::now();
+            if (!block.checkpoint && now - lastCheckpoint >= std::chrono::milliseconds(JOURNAL_CHECKPOINT_MS)) {
+                block.checkpoint = true;
+                if (currentRecords > 0) sealCurrent(true);
+                else lastCheckpoint = now;
+            }
+
+            lock.unlock();
+            bool ok = block.bytes.empty() || writeAll(block.bytes);
+            if (ok && block.checkpoint) ok = journal_sync(fileDescriptor) == 0;
+            lock.lock();
+
+            if (!ok) failed = true;
+            if (ok && block.checkpoint) ++checkpointTotal;
+        }
+    }
+
+    bool writeAll(const std::vector<uint8_t>& bytes) {
+        size_t offset = 0;
+        while (offset < bytes.size()) {
+            int written = journal_write(fileDescriptor, &bytes[offset], static_cast<unsigned>(bytes.size() - offset));
+            if (written < 0 && errno == EINTR) continue;
+            if (written <= 0) return false;
+            offset += static_cast<size_t>(written);
+        }
+        return true;
+    }
+};
+
+// Sequential reader for a capture journal. Blocks are read one at a time
+// and checked before any record is handed out; reading stops at the first
+// block that is missing, torn or out of order, which is where a crashed
+// writer left off.
+class JournalReader {
+private:
+    int fileDescriptor;
+    std::vector<uint8_t> block;
+    uint32_t nextBlockIndex;
+    bool damaged;
+    uint64_t createdAt;
+
+public:
+    JournalReader() : fileDescriptor(-1), block(JOURNAL_BLOCK_SIZE), nextBlockIndex(0), damaged(false), createdAt(0) {}
+    JournalReader(const JournalReader&) = delete;
+    JournalReader& operator=(const JournalReader&) = delete;
+    ~JournalReader() { close(); }
+
+    // Opens a journal and checks its header
+    bool open(const char* path) {
+        close();
+        fileDescriptor = journal_open(path, JOURNAL_READ_FLAGS);
+        if (fileDescriptor < 0) return false;
+
+        std::vector<uint8_t> header(JOURNAL_HEADER_SIZE);
+        if (!readFully(&header[0], header.size()) || !journalHeaderValid(&header[0])) {
+            close();
+            errno = EINVAL;
+            return false;
+        }
+        createdAt = readUInt64LE(&header[20]);
+        nextBlockIndex = 0;
+        damaged = false;
+        return true;
+    }
+
+    void close() {
+        if (fileDescriptor >= 0) journal_close(fileDescriptor);
+        fileDescriptor = -1;
+    }
+
+    // Decodes the next block into messages (and its receive times into
+    // timestamps, when given). Returns 0 at the end of the journal.
+    size_t nextBlock(std::vector<MarketMessage>& messages, std::vector<uint64_t>* timestamps = NULL) {
+        if (fileDescriptor < 0 || damaged) return 0;
+        size_t got = 0;
+        if (!readFully(&block[0], JOURNAL_BLOCK_SIZE, &got)) {
+            damaged = got > 0;   // a clean end falls exactly on a block boundary
+            return 0;
+        }
+
+        uint32_t records = journalBlockRecords(&block[0], nextBlockIndex);
+        if (records == 0 || readUInt32LE(&block[12]) != journalBlockChecksum(&block[0], records)) {
+            damaged = true;
+            return 0;
+        }
+        ++nextBlockIndex;
+
+        messages.resize(records);
+        decodePackets(&block[JOURNAL_BLOCK_HEADER_SIZE], records, &messages[0]);
+        if (timestamps) {
+            timestamps->resize(records);
+            for (uint32_t i = 0; i < records; ++i) {
+                (*timestamps)[i] = readUInt64LE(&block[JOURNAL_TIMESTAMPS_OFFSET + i * 8]);
+            }
+        }
+        return records;
+    }
+
+    // True when reading stopped at a damaged block rather than at a clean end
+    bool endedDamaged() const { return damaged; }
+    uint32_t blocksRead() const { return nextBlockIndex; }
+    uint64_t createdAtNs() const { return createdAt; }
+
+private:
+    bool readFully(uint8_t* out, size_t length, size_t* got = NULL) {
+        size_t offset = 0;
+        while (offset < length) {
+            int bytesRead = journal_read(fileDescriptor, out + offset, static_cast<unsigned>(length - offset));
+            if (bytesRead < 0 && errno == EINTR) continue;
+            if (bytesRead <= 0) break;
+            offset += static_cast<size_t>(bytesRead);
+        }
+        if (got) *got = offset;
+        return offset == length;
+    }
+};
+
+#endif // ABX_CAPTURE_JOURNAL_H
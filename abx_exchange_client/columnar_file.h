@@ -0,0 +1,472 @@
+#ifndef ABX_COLUMNAR_FILE_H
+#define ABX_COLUMNAR_FILE_H
+
+#include "wire_protocol.h"
+#include "symbol_table.h"
+#include "json_writer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+// Self-describing columnar export. All integers are little-endian.
+//
+//   header     magic "ABXCOL1\0", version u32
+//   row groups up to rowGroupRows rows each; one chunk per column, back to back
+//   footer     schema:       column count u32, then per column
+//                            [name length u8][name][type u8][encoding u8]
+//              dictionaries: symbol count u32 + 4-byte codes,
+//                            side count u32 + 1-byte sides (ids are positions)
+//              index:        rowGroupRows u32, total rows u64, row group count u32,
+//                            then per row group [offset u64][rows u32] and per
+//                            column [chunk bytes u32][min i32][max i32]
+//   trailer    footer length u32, magic "ABXCOL1\0"
+//
+// Chunk encodings:
+//   FOR        [reference i32][bit width u8][values - reference, bit-packed]
+//   DELTA_FOR  [first value i32] then FOR over the rows-1 successive differences
+//   DICT_FOR   FOR over dictionary ids
+// Bit-packed values are stored least significant bit first. A column whose
+// values are all equal (or, for DELTA_FOR, evenly spaced) packs to 0 bits.
+// The per-column min/max in the index let readers skip row groups, e.g.
+// when looking for a sequence range.
+const char COLUMNAR_MAGIC[8] = { 'A', 'B', 'X', 'C', 'O', 'L', '1', '\0' };
+const uint32_t COLUMNAR_VERSION = 1;
+const uint32_t COLUMNAR_ROW_GROUP_ROWS = 1 << 16;
+const size_t COLUMNAR_HEADER_SIZE = 12;
+const size_t COLUMNAR_TRAILER_SIZE = 12;
+
+enum ColumnarType : uint8_t { COLUMN_INT32 = 1, COLUMN_SYMBOL = 2, COLUMN_SIDE = 3 };
+enum ColumnarEncoding : uint8_t { ENCODING_FOR = 1, ENCODING_DELTA_FOR = 2, ENCODING_DICT_FOR = 3 };
+
+enum ColumnarColumn { COLUMN_SEQUENCE, COLUMN_SYMBOL_ID, COLUMN_SIDE_ID, COLUMN_SIZE, COLUMN_COST, COLUMNAR_COLUMN_COUNT };
+
+struct ColumnarColumnSpec {
+    const char* name;
+    ColumnarType type;
+    ColumnarEncoding encoding;
+};
+
+const ColumnarColumnSpec COLUMNAR_SCHEMA[COLUMNAR_COLUMN_COUNT] = {
+    { "sequenceNum", COLUMN_INT32, ENCODING_DELTA_FOR },
+    { "assetCode", COLUMN_SYMBOL, ENCODING_DICT_FOR },
+    { "orderDirection", COLUMN_SIDE, ENCODING_DICT_FOR },
+    { "size", COLUMN_INT32, ENCODING_FOR },
+    { "cost", COLUMN_INT32, ENCODING_FOR }
+};
+
+// Appends a frame-of-reference, bit-packed run of values to out
+inline void appendForEncoded(std::vector<uint8_t>& out, const int32_t* values, size_t count) {
+    int32_t low = 0, high = 0;
+    if (count > 0) {
+        low = high = values[0];
+        for (size_t i = 1; i < count; ++i) {
+            low = std::min(low, values[i]);
+            high = std::max(high, values[i]);
+        }
+    }
+    uint32_t span = static_cast<uint32_t>(high) - static_cast<uint32_t>(low);
+    uint8_t width = 0;
+    while (width < 32 && (span >> width) != 0) ++width;
+
+    size_t offset = out.size();
+    out.resize(offset + 5 + (count * width + 7) / 8);
+    writeUInt32LE(&out[offset], static_cast<uint32_t>(low));
+    out[offset + 4] = width;
+    if (width == 0) return;
+
+    uint8_t* packed = &out[offset + 5];
+    uint64_t pending = 0;
+    int pendingBits = 0;
+    for (size_t i = 0; i < count; ++i) {
+        pending |= static_cast<uint64_t>(static_cast<uint32_t>(values[i]) - static_cast<uint32_t>(low)) << pendingBits;
+        pendingBits += width;
+        while (pendingBits >= 8) {
+            *packed++ = static_cast<uint8_t>(pending);
+            pending >>= 8;
+            pendingBits -= 8;
+        }
+    }
+    if (pendingBits > 0) *packed = static_cast<uint8_t>(pending);
+}
+
+// Decodes count values written by appendForEncoded; returns the bytes read,
+// or 0 if the chunk is shorter than it claims
+inline size_t readForEncoded(const uint8_t* in, size_t available, int32_t* values, size_t count) {
+    if (available < 5) return 0;
+    uint32_t reference = readUInt32LE(in);
+    uint8_t width = in[4];
+    size_t length = 5 + (count * width + 7) / 8;
+    if (width > 32 || available < length) return 0;
+
+    const uint8_t* packed = in + 5;
+    uint64_t mask = (uint64_t(1) << width) - 1;
+    uint64_t pending = 0;
+    int pendingBits = 0;
+    for (size_t i = 0; i < count; ++i) {
+        while (pendingBits < width) {
+            pending |= static_cast<uint64_t>(*packed++) << pendingBits;
+            pendingBits += 8;
+        }
+        values[i] = static_cast<int32_t>(reference + static_cast<uint32_t>(pending & mask));
+        pending >>= width;
+        pendingBits -= width;
+    }
+    return length;
+}
+
+// Writes the columnar export. Rows are buffered per column until a row
+// group is full, then each column is encoded and the group is written in
+// one call. Rows normally arrive in sequence order, which is what makes
+// the sequence column pack to almost nothing, but any order is valid.
+class ColumnarWriter {
+private:
+    struct ChunkInfo {
+        uint32_t bytes;
+        int32_t low;
+        int32_t high;
+    };
+    struct RowGroupInfo {
+        uint64_t offset;
+        uint32_t rows;
+        ChunkInfo chunks[COLUMNAR_COLUMN_COUNT];
+    };
+
+    uint32_t rowGroupRows;
+    int fileDescriptor;
+    bool failed;
+    uint64_t offset;
+    uint64_t rowTotal;
+    std::vector<int32_t> columns[COLUMNAR_COLUMN_COUNT];
+    std::vector<uint8_t> encoded;
+    std::vector<int32_t> deltas;
+    SymbolTable symbols;
+    int16_t sideIds[256];
+    std::vector<char> sides;
+    std::vector<RowGroupInfo> rowGroups;
+
+public:
+    explicit ColumnarWriter(uint32_t rowsPerGroup = COLUMNAR_ROW_GROUP_ROWS)
+        : rowGroupRows(std::max<uint32_t>(1, rowsPerGroup)), fileDescriptor(-1), failed(false),
+          offset(0), rowTotal(0) {
+        std::fill(sideIds, sideIds + 256, -1);
+        for (int c = 0; c < COLUMNAR_COLUMN_COUNT; ++c) columns[c].reserve(rowGroupRows);
+    }
+
+    ColumnarWriter(const ColumnarWriter&) = delete;
+    ColumnarWriter& operator=(const ColumnarWriter&) = delete;
+    ~ColumnarWriter() { close(); }
+
+    bool open(const char* path) {
+        fileDescriptor = ::platform_open(path, OUTPUT_FILE_FLAGS, 0644);
+        failed = fileDescriptor < 0;
+        if (failed) return false;
+        encoded.assign(COLUMNAR_MAGIC, COLUMNAR_MAGIC + sizeof(COLUMNAR_MAGIC));
+        encoded.resize(COLUMNAR_HEADER_SIZE);
+        writeUInt32LE(&encoded[8], COLUMNAR_VERSION);
+        return writeEncoded();
+    }
+
+    bool isOpen() const { return fileDescriptor >= 0; }
+
+    void write(const MarketMessage& message) {
+        columns[COLUMN_SEQUENCE].push_back(message.sequenceNum);
+        columns[COLUMN_SYMBOL_ID].push_back(static_cast<int32_t>(symbols.intern(message.assetCode) - 1));
+        columns[COLUMN_SIDE_ID].push_back(sideId(message.orderDirection));
+        columns[COLUMN_SIZE].push_back(message.size);
+        columns[COLUMN_COST].push_back(message.cost);
+        if (columns[COLUMN_SEQUENCE].size() == rowGroupRows) flushRowGroup();
+    }
+
+    // Writes the last row group and the footer and closes the file
+    bool close() {
+        if (fileDescriptor < 0) return !failed;
+        if (!columns[COLUMN_SEQUENCE].empty()) flushRowGroup();
+        writeFooter();
+        if (::platform_close(fileDescriptor) != 0) failed = true;
+        fileDescriptor = -1;
+        return !failed;
+    }
+
+    uint64_t bytesWritten() const { return offset; }
+    uint64_t rowCount() const { return rowTotal; }
+    size_t rowGroupCount() const { return rowGroups.size(); }
+
+private:
+    int32_t sideId(char side) {
+        int16_t& id = sideIds[static_cast<uint8_t>(side)];
+        if (id < 0) {
+            id = static_cast<int16_t>(sides.size());
+            sides.push_back(side);
+        }
+        return id;
+    }
+
+    void flushRowGroup() {
+        RowGroupInfo group;
+        group.offset = offset;
+        group.rows = static_cast<uint32_t>(columns[COLUMN_SEQUENCE].size());
+        encoded.clear();
+        for (int c = 0; c < COLUMNAR_COLUMN_COUNT; ++c) {
+            const std::vector<int32_t>& values = columns[c];
+            size_t chunkStart = encoded.size();
+            if (COLUMNAR_SCHEMA[c].encoding == ENCODING_DELTA_FOR) {
+                encoded.resize(chunkStart + 4);
+                writeUInt32LE(&encoded[chunkStart], static_cast<uint32_t>(values[0]));
+                deltas.resize(values.size() - 1);
+                for (size_t i = 1; i < values.size(); ++i) {
+                    deltas[i - 1] = static_cast<int32_t>(static_cast<uint32_t>(values[i]) - static_cast<uint32_t>(values[i - 1]));
+                }
+                appendForEncoded(encoded, deltas.empty() ? NULL : &deltas[0], deltas.size());
+            } else {
+                appendForEncoded(encoded, &values[0], values.size());
+            }
+            ChunkInfo& chunk = group.chunks[c];
+            chunk.bytes = static_cast<uint32_t>(encoded.size() - chunkStart);
+            chunk.low = *std::min_element(values.begin(), values.end());
+            chunk.high = *std::max_element(values.begin(), values.end());
+            columns[c].clear();
+        }
+        rowGroups.push_back(group);
+        rowTotal += group.rows;
+        writeEncoded();
+    }
+
+    void writeFooter() {
+        encoded.clear();
+        appendUInt32(COLUMNAR_COLUMN_COUNT);
+        for (int c = 0; c < COLUMNAR_COLUMN_COUNT; ++c) {
+            size_t nameLength = strlen(COLUMNAR_SCHEMA[c].name);
+            encoded.push_back(static_cast<uint8_t>(nameLength));
+            encoded.insert(encoded.end(), COLUMNAR_SCHEMA[c].name, COLUMNAR_SCHEMA[c].name + nameLength);
+            encoded.push_back(COLUMNAR_SCHEMA[c].type);
+            encoded.push_back(COLUMNAR_SCHEMA[c].encoding);
+        }
+
+        appendUInt32(static_cast<uint32_t>(symbols.size()));
+        for (uint32_t id = 1; id <= symbols.size(); ++id) {
+            char code[4];
+            symbols.copyCode(id, code);
+            encoded.insert(encoded.end(), code, code + 4);
+        }
+        appendUInt32(static_cast<uint32_t>(sides.size()));
+        encoded.insert(encoded.end(), sides.begin(), sides.end());
+
+        appendUInt32(rowGroupRows);
+        appendUInt32(static_cast<uint32_t>(rowTotal));
+        appendUInt32(static_cast<uint32_t>(rowTotal >> 32));
+        appendUInt32(static_cast<uint32_t>(rowGroups.size()));
+        for (size_t g = 0; g < rowGroups.size(); ++g) {
+            appendUInt32(static_cast<uint32_t>(rowGroups[g].offset));
+            appendUInt32(static_cast<uint32_t>(rowGroups[g].offset >> 32));
+            appendUInt32(rowGroups[g].rows);
+            for (int c = 0; c < COLUMNAR_COLUMN_COUNT; ++c) {
+                appendUInt32(rowGroups[g].chunks[c].bytes);
+                appendUInt32(static_cast<uint32_t>(rowGroups[g].chunks[c].low));
+                appendUInt32(static_cast<uint32_t>(rowGroups[g].chunks[c].high));
+            }
+        }
+
+        uint32_t footerLength = static_cast<uint32_t>(encoded.size());
+        appendUInt32(footerLength);
+        encoded.insert(encoded.end(), COLUMNAR_MAGIC, COLUMNAR_MAGIC + sizeof(COLUMNAR_MAGIC));
+        writeEncoded();
+    }
+
+    void appendUInt32(uint32_t value) {
+        size_t at = encoded.size();
+        encoded.resize(at + 4);
+        writeUInt32LE(&encoded[at], value);
+    }
+
+    bool writeEncoded() {
+        size_t written = 0;
+        while (!failed && written < encoded.size()) {
+            int result = ::platform_write(fileDescriptor, &encoded[written], static_cast<unsigned>(encoded.size() - written));
+            if (result < 0 && errno == EINTR) continue;
+            if (result <= 0) {
+                failed = true;
+                break;
+            }
+            written += static_cast<size_t>(result);
+        }
+        offset += written;
+        return !failed;
+    }
+};
+
+// Reads a columnar export back. The whole file is loaded and the footer
+// parsed on open; row groups are decoded on request, so tools that want a
+// sequence range can pick groups with rowGroupSequences() first.
+class ColumnarReader {
+private:
+    struct RowGroup {
+        uint64_t offset;
+        uint32_t rows;
+        uint32_t chunkBytes[COLUMNAR_COLUMN_COUNT];
+        int32_t low[COLUMNAR_COLUMN_COUNT];
+        int32_t high[COLUMNAR_COLUMN_COUNT];
+    };
+
+    std::vector<uint8_t> file;
+    std::vector<char> symbolCodes;   // 4 bytes per dictionary id
+    std::vector<char> sides;
+    std::vector<RowGroup> rowGroups;
+    std::vector<int32_t> columns[COLUMNAR_COLUMN_COUNT];
+    uint64_t rowTotal;
+
+public:
+    ColumnarReader() : rowTotal(0) {}
+
+    // Loads the file and checks its header, trailer and footer
+    bool open(const char* path) {
+        file.clear();
+        rowGroups.clear();
+        FILE* input = fopen(path, "rb");
+        if (!input) return false;
+        uint8_t chunk[1 << 16];
+        size_t bytesRead;
+        while ((bytesRead = fread(chunk, 1, sizeof(chunk), input)) > 0) file.insert(file.end(), chunk, chunk + bytesRead);
+        bool readFailed = ferror(input) != 0;
+        fclose(input);
+        if (readFailed || !parseFooter()) {
+            file.clear();
+            rowGroups.clear();
+            errno = EINVAL;
+            return false;
+        }
+        return true;
+    }
+
+    size_t rowGroupCount() const { return rowGroups.size(); }
+    uint64_t rowCount() const { return rowTotal; }
+    size_t symbolCount() const { return symbolCodes.size() / 4; }
+
+    // Encoded bytes of one column over all row groups
+    uint64_t columnBytes(int column) const {
+        uint64_t total = 0;
+        for (size_t g = 0; g < rowGroups.size(); ++g) total += rowGroups[g].chunkBytes[column];
+        return total;
+    }
+
+    // Sequence range of a row group, from the footer index alone
+    SequenceRange rowGroupSequences(size_t index) const {
+        SequenceRange range = { rowGroups[index].low[COLUMN_SEQUENCE],
+                                rowGroups[index].high[COLUMN_SEQUENCE] - rowGroups[index].low[COLUMN_SEQUENCE] + 1 };
+        return range;
+    }
+
+    // Decodes one row group; false if its chunks are malformed
+    bool readRowGroup(size_t index, std::vector<MarketMessage>& messages) {
+        const RowGroup& group = rowGroups[index];
+        const uint8_t* chunk = &file[0] + group.offset;
+        for (int c = 0; c < COLUMNAR_COLUMN_COUNT; ++c) {
+            std::vector<int32_t>& values = columns[c];
+            values.resize(group.rows);
+            size_t bytes = group.chunkBytes[c];
+            if (COLUMNAR_SCHEMA[c].encoding == ENCODING_DELTA_FOR) {
+                if (bytes < 4 || !readForEncoded(chunk + 4, bytes - 4, &values[0] + 1, group.rows - 1)) return false;
+                values[0] = static_cast<int32_t>(readUInt32LE(chunk));
+                for (size_t i = 1; i < group.rows; ++i) {
+                    values[i] = static_cast<int32_t>(static_cast<uint32_t>(values[i - 1]) + static_cast<uint32_t>(values[i]));
+                }
+            } else if (!readForEncoded(chunk, bytes, &values[0], group.rows)) {
+                return false;
+            }
+            chunk += bytes;
+        }
+
+        messages.resize(group.rows);
+        for (size_t i = 0; i < group.rows; ++i) {
+            uint32_t symbol = static_cast<uint32_t>(columns[COLUMN_SYMBOL_ID][i]);
+            uint32_t side = static_cast<uint32_t>(columns[COLUMN_SIDE_ID][i]);
+            if (symbol >= symbolCount() || side >= sides.size()) return false;
+            MarketMessage& message = messages[i];
+            memcpy(message.assetCode, &symbolCodes[symbol * 4], 4);
+            message.assetCode[4] = '\0';
+            message.orderDirection = sides[side];
+            message.size = columns[COLUMN_SIZE][i];
+            message.cost = columns[COLUMN_COST][i];
+            message.sequenceNum = columns[COLUMN_SEQUENCE][i];
+        }
+        return true;
+    }
+
+private:
+    bool parseFooter() {
+        if (file.size() < COLUMNAR_HEADER_SIZE + COLUMNAR_TRAILER_SIZE ||
+            memcmp(&file[0], COLUMNAR_MAGIC, sizeof(COLUMNAR_MAGIC)) != 0 ||
+            readUInt32LE(&file[8]) != COLUMNAR_VERSION ||
+            memcmp(&file[file.size() - 8], COLUMNAR_MAGIC, sizeof(COLUMNAR_MAGIC)) != 0) {
+            return false;
+        }
+        uint64_t footerLength = readUInt32LE(&file[file.size() - COLUMNAR_TRAILER_SIZE]);
+        if (footerLength > file.size() - COLUMNAR_HEADER_SIZE - COLUMNAR_TRAILER_SIZE) return false;
+        size_t footerStart = file.size() - COLUMNAR_TRAILER_SIZE - static_cast<size_t>(footerLength);
+        const uint8_t* cursor = &file[footerStart];
+        const uint8_t* end = cursor + footerLength;
+
+        uint32_t columnCount;
+        if (!take32(cursor, end, columnCount) || columnCount != COLUMNAR_COLUMN_COUNT) return false;
+        for (uint32_t c = 0; c < columnCount; ++c) {
+            if (cursor >= end) return false;
+            size_t nameLength = *cursor++;
+            if (static_cast<size_t>(end - cursor) < nameLength + 2 ||
+                nameLength != strlen(COLUMNAR_SCHEMA[c].name) ||
+                memcmp(cursor, COLUMNAR_SCHEMA[c].name, nameLength) != 0 ||
+                cursor[nameLength] != COLUMNAR_SCHEMA[c].type || cursor[nameLength + 1] != COLUMNAR_SCHEMA[c].encoding) {
+                return false;
+            }
+            cursor += nameLength + 2;
+        }
+
+        uint32_t count;
+        if (!take32(cursor, end, count) || static_cast<uint64_t>(end - cursor) < uint64_t(count) * 4) return false;
+        symbolCodes.assign(cursor, cursor + count * 4);
+        cursor += count * 4;
+        if (!take32(cursor, end, count) || static_cast<uint64_t>(end - cursor) < count) return false;
+        sides.assign(cursor, cursor + count);
+        cursor += count;
+
+        uint32_t rowsPerGroup, rowsLow, rowsHigh, groupCount;
+        if (!take32(cursor, end, rowsPerGroup) || !take32(cursor, end, rowsLow) ||
+            !take32(cursor, end, rowsHigh) || !take32(cursor, end, groupCount)) {
+            return false;
+        }
+        rowTotal = (static_cast<uint64_t>(rowsHigh) << 32) | rowsLow;
+        uint64_t indexedRows = 0;
+        for (uint32_t g = 0; g < groupCount; ++g) {
+            RowGroup group;
+            uint32_t offsetLow, offsetHigh;
+            if (!take32(cursor, end, offsetLow) || !take32(cursor, end, offsetHigh) ||
+                !take32(cursor, end, group.rows) || group.rows == 0) {
+                return false;
+            }
+            group.offset = (static_cast<uint64_t>(offsetHigh) << 32) | offsetLow;
+            uint64_t groupBytes = 0;
+            for (int c = 0; c < COLUMNAR_COLUMN_COUNT; ++c) {
+                uint32_t low, high;
+                if (!take32(cursor, end, group.chunkBytes[c]) || !take32(cursor, end, low) ||
+                    !take32(cursor, end, high)) {
+                    return false;
+                }
+                group.low[c] = static_cast<int32_t>(low);
+                group.high[c] = static_cast<int32_t>(high);
+                groupBytes += group.chunkBytes[c];
+            }
+            if (group.offset < COLUMNAR_HEADER_SIZE || group.offset + groupBytes > footerStart) return false;
+            indexedRows += group.rows;
+            rowGroups.push_back(group);
+        }
+        return indexedRows == rowTotal;
+    }
+
+    static bool take32(const uint8_t*& cursor, const uint8_t* end, uint32_t& value) {
+        if (end - cursor < 4) return false;
+        value = readUInt32LE(cursor);
+        cursor += 4;
+        return true;
+    }
+};
+
+#endif // ABX_COLUMNAR_FILE_H
@@ -0,0 +1,163 @@
+#ifndef ABX_EVENT_LOOP_H
+#define ABX_EVENT_LOOP_H
+
+#include "platform.h"
+
+#include <cstddef>
+#include <vector>
+
+#if defined(__linux__)
+    #define ABX_EVENT_LOOP_EPOLL 1
+    #include <sys/epoll.h>
+#elif !defined(_WIN32)
+    #include <poll.h>
+#endif
+
+const int EVENT_LOOP_MAX_EVENTS = 64;
+
+// Readiness notification for many sockets on one thread. Each socket is
+// registered with a caller-chosen token and wait() returns the tokens of
+// the sockets that became readable (or were closed by the peer), or
+// writable while watchWritable() is on for them. On Linux
+// this is edge-triggered epoll, so a handler must read until the socket
+// reports WOULD_BLOCK before waiting again; elsewhere it falls back to
+// poll()/WSAPoll, which is level-triggered and works with the same
+// read-until-drained handlers.
+class EventLoop {
+private:
+    #ifdef ABX_EVENT_LOOP_EPOLL
+        int epollHandle;
+        struct epoll_event events[EVENT_LOOP_MAX_EVENTS];
+    #else
+        #ifdef _WIN32
+            std::vector<WSAPOLLFD> descriptors;
+        #else
+            std::vector<struct pollfd> descriptors;
+        #endif
+        std::vector<size_t> descriptorTokens;
+    #endif
+
+public:
+    EventLoop() {
+        #ifdef ABX_EVENT_LOOP_EPOLL
+            epollHandle = epoll_create1(0);
+        #endif
+    }
+
+    ~EventLoop() {
+        #ifdef ABX_EVENT_LOOP_EPOLL
+            if (epollHandle >= 0) close(epollHandle);
+        #endif
+    }
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    bool valid() const {
+        #ifdef ABX_EVENT_LOOP_EPOLL
+            return epollHandle >= 0;
+        #else
+            return true;
+        #endif
+    }
+
+    bool add(SocketHandle socketHandle, size_t token, bool writable = false) {
+        #ifdef ABX_EVENT_LOOP_EPOLL
+            struct epoll_event event = epollEvent(token, writable);
+            return epoll_ctl(epollHandle, EPOLL_CTL_ADD, socketHandle, &event) == 0;
+        #else
+            #ifdef _WIN32
+                WSAPOLLFD descriptor = { socketHandle, pollEvents(writable), 0 };
+            #else
+                struct pollfd descriptor = { socketHandle, pollEvents(writable), 0 };
+            #endif
+            descriptors.push_back(descriptor);
+            descriptorTokens.push_back(token);
+            return true;
+        #endif
+    }
+
+    // Turns writability reporting on or off for a registered socket. Leave
+    // it off unless something is waiting to be written: the poll() fallback
+    // is level-triggered and would wake for every writable socket.
+    bool watchWritable(SocketHandle socketHandle, size_t token, bool writable) {
+        #ifdef ABX_EVENT_LOOP_EPOLL
+            struct epoll_event event = epollEvent(token, writable);
+            return epoll_ctl(epollHandle, EPOLL_CTL_MOD, socketHandle, &event) == 0;
+        #else
+            (void)token;
+            for (size_t i = 0; i < descriptors.size(); ++i) {
+                if (descriptors[i].fd != socketHandle) continue;
+                descriptors[i].events = pollEvents(writable);
+                return true;
+            }
+            return false;
+        #endif
+    }
+
+    // Must be called before the socket is closed
+    void remove(SocketHandle socketHandle) {
+        #ifdef ABX_EVENT_LOOP_EPOLL
+            struct epoll_event unused;
+            epoll_ctl(epollHandle, EPOLL_CTL_DEL, socketHandle, &unused);
+        #else
+            for (size_t i = 0; i < descriptors.size(); ++i) {
+                if (descriptors[i].fd != socketHandle) continue;
+                descriptors.erase(descriptors.begin() + i);
+                descriptorTokens.erase(descriptorTokens.begin() + i);
+                return;
+            }
+        #endif
+    }
+
+    // Waits up to timeoutMs for readiness and replaces ready with the
+    // tokens of the sockets that have something to read or, if watched,
+    // room to write. Returns false on an unrecoverable error.
+    bool wait(int timeoutMs, std::vector<size_t>& ready) {
+        ready.clear();
+        #ifdef ABX_EVENT_LOOP_EPOLL
+            int count = epoll_wait(epollHandle, events, EVENT_LOOP_MAX_EVENTS, timeoutMs);
+            if (count < 0) return errno == EINTR;
+            for (int i = 0; i < count; ++i) ready.push_back(static_cast<size_t>(events[i].data.u64));
+        #else
+            if (descriptors.empty()) {
+                delay_milliseconds(timeoutMs);
+                return true;
+            }
+            #ifdef _WIN32
+                int count = WSAPoll(&descriptors[0], static_cast<ULONG>(descriptors.size()), timeoutMs);
+                if (count < 0) return false;
+            #else
+                int count = poll(&descriptors[0], descriptors.size(), timeoutMs);
+                if (count < 0) return errno == EINTR;
+            #endif
+            for (size_t i = 0; i < descriptors.size() && count > 0; ++i) {
+                if (descriptors[i].revents == 0) continue;
+                ready.push_back(descriptorTokens[i]);
+                --count;
+            }
+        #endif
+        return true;
+    }
+
+private:
+    #ifdef ABX_EVENT_LOOP_EPOLL
+        static struct epoll_event epollEvent(size_t token, bool writable) {
+            struct epoll_event event;
+            event.events = EPOLLIN | EPOLLRDHUP | EPOLLET;
+            if (writable) event.events |= EPOLLOUT;
+            event.data.u64 = token;
+            return event;
+        }
+    #else
+        static short pollEvents(bool writable) {
+            #ifdef _WIN32
+                return static_cast<short>(POLLRDNORM | (writable ? POLLWRNORM : 0));
+            #else
+                return static_cast<short>(POLLIN | (writable ? POLLOUT : 0));
+            #endif
+        }
+    #endif
+};
+
+#endif // ABX_EVENT_LOOP_H
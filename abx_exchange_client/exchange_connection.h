@@ -0,0 +1,286 @@
+#ifndef ABX_EXCHANGE_CONNECTION_H
+#define ABX_EXCHANGE_CONNECTION_H
+
+#include "platform.h"
+#include "wire_protocol.h"
+#include "receive_buffer.h"
+#include "utilities.h"
+#include "uring_receiver.h"
+
+#include <chrono>
+#include <vector>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+#endif
+
+// Outcome of ExchangeConnection::startConnect()
+enum class ConnectStatus {
+    CONNECTED,     // connected straight away
+    IN_PROGRESS,   // wait for the socket to become writable, then call finishConnect()
+    FAILED         // already reported
+};
+
+// Outcome of ExchangeConnection::receive()
+enum class ReceiveStatus {
+    MESSAGES,      // at least one message was decoded
+    WOULD_BLOCK,   // nothing buffered and the socket has no data (or the receive timeout expired)
+    CLOSED,        // the peer closed the connection
+    FAILED         // socket error, already reported
+};
+
+// One TCP connection to the exchange: the socket, its receive buffer and the
+// time of its latest read. Works in blocking mode, optionally with a receive
+// timeout, or in non-blocking mode under an EventLoop; receive() behaves
+// the same way in both and only its WOULD_BLOCK result means something
+// different. In non-blocking mode startConnect() and send() do not wait
+// either: the caller watches for writability and then calls finishConnect()
+// or flushSend(). useUring() moves reads onto an io_uring multishot recv where
+// the kernel supports it. The socket is closed by close() or the destructor.
+class ExchangeConnection {
+private:
+    SocketHandle socketHandle;
+    bool open;
+    bool nonBlocking;
+    int receiveTimeoutMs;
+    ReceiveBuffer receiveBuffer;
+    std::vector<uint8_t> pendingSend;   // bytes a non-blocking send could not hand over yet
+    UringReceiver uring;
+    std::chrono::steady_clock::time_point lastRead;
+
+public:
+    ExchangeConnection() : socketHandle(), open(false), nonBlocking(false), receiveTimeoutMs(0) {}
+    ExchangeConnection(const ExchangeConnection&) = delete;
+    ExchangeConnection& operator=(const ExchangeConnection&) = delete;
+    ~ExchangeConnection() { close(); }
+
+    // Blocking connect; the socket starts out in blocking mode
+    bool connect(const char* ip, int port) {
+        if (!openSocket()) return false;
+        struct sockaddr_in serverAddress = addressOf(ip, port);
+        if (::connect(socketHandle, (struct sockaddr*)&serverAddress, sizeof(serverAddress)) < 0) {
+            #ifdef _WIN32
+                Utilities::printError(NetworkErrorType::CONNECTION, WSAGetLastError());
+            #else
+                Utilities::printError(NetworkErrorType::CONNECTION);
+            #endif
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    // Non-blocking connect for use under an EventLoop; the socket is left
+    // in non-blocking mode whatever the outcome
+    ConnectStatus startConnect(const char* ip, int port) {
+        if (!openSocket()) return ConnectStatus::FAILED;
+        if (!setNonBlocking(true)) {
+            close();
+            return ConnectStatus::FAILED;
+        }
+        struct sockaddr_in serverAddress = addressOf(ip, port);
+        if (::connect(socketHandle, (struct sockaddr*)&serverAddress, sizeof(serverAddress)) == 0) {
+            return ConnectStatus::CONNECTED;
+        }
+        #ifdef _WIN32
+            int error = WSAGetLastError();
+            if (error == WSAEWOULDBLOCK) return ConnectStatus::IN_PROGRESS;
+            Utilities::printError(NetworkErrorType::CONNECTION, error);
+        #else
+            if (errno == EINPROGRESS || errno == EINTR) return ConnectStatus::IN_PROGRESS;
+            Utilities::printError(NetworkErrorType::CONNECTION, errno);
+        #endif
+        close();
+        return ConnectStatus::FAILED;
+    }
+
+    // Completes an IN_PROGRESS connect once the socket is writable (or has
+    // reported an error). A failed connect is reported; the caller closes it.
+    bool finishConnect() {
+        int error = 0;
+        socklen_t length = sizeof(error);
+        if (getsockopt(socketHandle, SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>(&error), &length) != 0) {
+            #ifdef _WIN32
+                error = WSAGetLastError();
+            #else
+                error = errno;
+            #endif
+        }
+        if (error == 0) return true;
+        Utilities::printError(NetworkErrorType::CONNECTION, error);
+        return false;
+    }
+
+    void close() {
+        if (!open) return;
+        uring.stop();
+        #ifdef _WIN32
+            closesocket(socketHandle);
+        #else
+            ::close(socketHandle);
+        #endif
+        open = false;
+        pendingSend.clear();
+    }
+
+    bool isOpen() const { return open; }
+    SocketHandle handle() const { return socketHandle; }
+
+    // What an EventLoop should watch for this connection's input
+    SocketHandle pollHandle() const { return uring.active() ? uring.handle() : socketHandle; }
+
+    // Switches reads to io_uring. Returns false, leaving recv() in place,
+    // when the kernel does not support it; uringError() then says why.
+    bool useUring() { return open && uring.start(socketHandle); }
+    bool usingUring() const { return uring.active(); }
+    int uringError() const { return uring.lastStartError(); }
+
+    // Syscalls spent receiving: recv() calls plus io_uring_enter() calls
+    size_t receiveSyscallCount() const { return receiveBuffer.receiveCallCount() + uring.enterCallCount(); }
+    std::chrono::steady_clock::time_point lastReadAt() const { return lastRead; }
+
+    void setReceiveTimeout(int timeoutMs) {
+        receiveTimeoutMs = timeoutMs;
+        #ifdef _WIN32
+            DWORD timeout = static_cast<DWORD>(timeoutMs);
+        #else
+            struct timeval timeout;
+            timeout.tv_sec = timeoutMs / 1000;
+            timeout.tv_usec = (timeoutMs % 1000) * 1000;
+        #endif
+        setsockopt(socketHandle, SOL_SOCKET, SO_RCVTIMEO,
+            reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+    }
+
+    // Under io_uring the socket itself stays blocking: the multishot recv
+    // does the waiting, and receive() simply does not sleep on the ring.
+    bool setNonBlocking(bool enable) {
+        if (uring.active()) {
+            nonBlocking = enable;
+            return true;
+        }
+        #ifdef _WIN32
+            u_long mode = enable ? 1 : 0;
+            if (ioctlsocket(socketHandle, FIONBIO, &mode) != 0) return false;
+        #else
+            int flags = fcntl(socketHandle, F_GETFL, 0);
+            if (flags < 0) return false;
+            flags = enable ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK);
+            if (fcntl(socketHandle, F_SETFL, flags) < 0) return false;
+        #endif
+        nonBlocking = enable;
+        return true;
+    }
+
+    // Sends every byte. On a non-blocking socket whatever the send buffer
+    // cannot take is kept, in order, until flushSend() is called once the
+    // socket is writable again; sendPending() says whether any is left.
+    bool send(const std::vector<uint8_t>& bytes) {
+        if (!pendingSend.empty()) {
+            pendingSend.insert(pendingSend.end(), bytes.begin(), bytes.end());
+            return flushSend();
+        }
+        size_t sent;
+        if (!sendSome(bytes, sent)) return false;
+        pendingSend.assign(bytes.begin() + sent, bytes.end());
+        return true;
+    }
+
+    bool flushSend() {
+        size_t sent;
+        if (!sendSome(pendingSend, sent)) return false;
+        pendingSend.erase(pendingSend.begin(), pendingSend.begin() + sent);
+        return true;
+    }
+
+    bool sendPending() const { return !pendingSend.empty(); }
+
+    // Decodes up to maxCount buffered packets into messages, reading from the
+    // socket only when no complete packet is buffered
+    ReceiveStatus receive(MarketMessage* messages, size_t maxCount, size_t& count) {
+        while ((count = receiveBuffer.nextMessages(messages, maxCount)) == 0) {
+            int bytesReceived = uring.active()
+                ? uring.fill(receiveBuffer, !nonBlocking, receiveTimeoutMs)
+                : receiveBuffer.fill(socketHandle);
+
+            if (bytesReceived <= 0) {
+                if (bytesReceived == 0) return ReceiveStatus::CLOSED;
+
+                #ifdef _WIN32
+                    int error = WSAGetLastError();
+                    if (error == WSAEINTR) continue;
+                    if (error == WSAETIMEDOUT || error == WSAEWOULDBLOCK) return ReceiveStatus::WOULD_BLOCK;
+                    Utilities::printError(NetworkErrorType::DATA_RECEPTION, error);
+                #else
+                    if (errno == EINTR) continue;
+                    if (errno == EAGAIN || errno == EWOULDBLOCK) return ReceiveStatus::WOULD_BLOCK;
+                    Utilities::printError(NetworkErrorType::DATA_RECEPTION, errno);
+                #endif
+                return ReceiveStatus::FAILED;
+            }
+            lastRead = std::chrono::steady_clock::now();
+        }
+        return ReceiveStatus::MESSAGES;
+    }
+
+    const ReceiveBuffer& buffer() const { return receiveBuffer; }
+
+private:
+    // Closes any previous socket and opens a fresh blocking one
+    bool openSocket() {
+        close();
+        #ifdef _WIN32
+            socketHandle = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+            if (socketHandle == INVALID_SOCKET) {
+                Utilities::printError(NetworkErrorType::SOCKET_CREATION, WSAGetLastError());
+                return false;
+            }
+        #else
+            socketHandle = socket(AF_INET, SOCK_STREAM, 0);
+            if (socketHandle < 0) {
+                Utilities::printError(NetworkErrorType::SOCKET_CREATION);
+                return false;
+            }
+        #endif
+        receiveBuffer.reset();
+        nonBlocking = false;
+        receiveTimeoutMs = 0;
+        open = true;
+        return true;
+    }
+
+    static struct sockaddr_in addressOf(const char* ip, int port) {
+        struct sockaddr_in serverAddress;
+        memset(&serverAddress, 0, sizeof(serverAddress));
+        serverAddress.sin_family = AF_INET;
+        serverAddress.sin_port = htons(static_cast<uint16_t>(port));
+        serverAddress.sin_addr.s_addr = inet_addr(ip);
+        return serverAddress;
+    }
+
+    // Sends from the front of bytes until everything is sent or, on a
+    // non-blocking socket, the send buffer is full
+    bool sendSome(const std::vector<uint8_t>& bytes, size_t& sent) {
+        sent = 0;
+        while (sent < bytes.size()) {
+            int bytesSent = ::send(socketHandle,
+                reinterpret_cast<const char*>(&bytes[sent]),
+                static_cast<int>(bytes.size() - sent), SEND_FLAGS);
+            if (bytesSent < 0) {
+                #ifdef _WIN32
+                    int error = WSAGetLastError();
+                    if (error == WSAEINTR) continue;
+                    if (error == WSAEWOULDBLOCK && nonBlocking) return true;
+                #else
+                    if (errno == EINTR) continue;
+                    if ((errno == EAGAIN || errno == EWOULDBLOCK) && nonBlocking) return true;
+                #endif
+                return false;
+            }
+            sent += static_cast<size_t>(bytesSent);
+        }
+        return true;
+    }
+};
+
+#endif // ABX_EXCHANGE_CONNECTION_H
@@ -0,0 +1,80 @@
+#ifndef ABX_GAP_TRACKER_H
+#define ABX_GAP_TRACKER_H
+
+#include "wire_protocol.h"
+
+#include <map>
+
+// Tracks missing sequence numbers while messages are still arriving.
+// Each record() either extends the contiguous high-water mark, opens a new
+// gap behind a jump, or fills a sequence inside an open gap. Open gaps are
+// kept as disjoint intervals, so the cost depends on the number of gaps
+// rather than on the highest sequence seen.
+class GapTracker {
+private:
+    std::map<int32_t, int32_t> openGaps;   // first missing sequence -> last missing sequence
+    int32_t highestSequence;
+    int64_t missingTotal;
+
+public:
+    GapTracker() : highestSequence(0), missingTotal(0) {}
+
+    // Records a received sequence. Returns true and sets newGap when the
+    // sequence jumped past the high-water mark and opened a gap.
+    bool record(int32_t seq, SequenceRange& newGap) {
+        if (seq <= 0) return false;
+        if (seq > highestSequence) {
+            bool opened = seq > highestSequence + 1;
+            if (opened) {
+                newGap.start = highestSequence + 1;
+                newGap.count = seq - newGap.start;
+                openGaps[newGap.start] = seq - 1;
+                missingTotal += newGap.count;
+            }
+            highestSequence = seq;
+            return opened;
+        }
+        fill(seq);
+        return false;
+    }
+
+    bool isMissing(int32_t seq) const {
+        std::map<int32_t, int32_t>::const_iterator it = findGap(seq);
+        return it != openGaps.end();
+    }
+
+    int32_t highest() const { return highestSequence; }
+    int64_t missingCount() const { return missingTotal; }
+    size_t openGapCount() const { return openGaps.size(); }
+
+    // Calls visit(SequenceRange) for every open gap in ascending order
+    template <typename Visitor>
+    void forEachGap(Visitor visit) const {
+        for (std::map<int32_t, int32_t>::const_iterator it = openGaps.begin(); it != openGaps.end(); ++it) {
+            SequenceRange gap = { it->first, it->second - it->first + 1 };
+            visit(gap);
+        }
+    }
+
+private:
+    std::map<int32_t, int32_t>::const_iterator findGap(int32_t seq) const {
+        std::map<int32_t, int32_t>::const_iterator it = openGaps.upper_bound(seq);
+        if (it == openGaps.begin()) return openGaps.end();
+        --it;
+        return seq <= it->second ? it : openGaps.end();
+    }
+
+    // Removes seq from its gap, splitting the gap if seq was in the middle
+    void fill(int32_t seq) {
+        std::map<int32_t, int32_t>::const_iterator it = findGap(seq);
+        if (it == openGaps.end()) return;
+
+        int32_t first = it->first, last = it->second;
+        openGaps.erase(first);
+        if (first < seq) openGaps[first] = seq - 1;
+        if (seq < last) openGaps[seq + 1] = last;
+        --missingTotal;
+    }
+};
+
+#endif // ABX_GAP_TRACKER_H
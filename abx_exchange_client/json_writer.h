@@ -0,0 +1,158 @@
+#ifndef ABX_JSON_WRITER_H
+#define ABX_JSON_WRITER_H
+
+#include "wire_protocol.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <vector>
+
+#ifdef _WIN32
+    #include <io.h>
+    #define platform_open _open
+    #define platform_write _write
+    #define platform_close _close
+    const int OUTPUT_FILE_FLAGS = _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY;
+#else
+    #include <unistd.h>
+    #define platform_open open
+    #define platform_write write
+    #define platform_close close
+    const int OUTPUT_FILE_FLAGS = O_WRONLY | O_CREAT | O_TRUNC;
+#endif
+
+const size_t JSON_BUFFER_SIZE = 1 << 20;
+const size_t JSON_MAX_RECORD_SIZE = 256;   // longest record is ~180 bytes
+
+// "00" "01" ... "99", used to emit two decimal digits per division
+const char DECIMAL_DIGIT_PAIRS[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+// Writes value in decimal at out and returns the end of the digits
+inline char* writeDecimal(char* out, int32_t value) {
+    uint32_t magnitude = static_cast<uint32_t>(value);
+    if (value < 0) {
+        *out++ = '-';
+        magnitude = 0u - magnitude;
+    }
+
+    char digits[10];
+    char* end = digits + sizeof(digits);
+    char* cursor = end;
+    while (magnitude >= 100) {
+        const char* pair = DECIMAL_DIGIT_PAIRS + (magnitude % 100) * 2;
+        magnitude /= 100;
+        *--cursor = pair[1];
+        *--cursor = pair[0];
+    }
+    if (magnitude >= 10) {
+        const char* pair = DECIMAL_DIGIT_PAIRS + magnitude * 2;
+        *--cursor = pair[1];
+        *--cursor = pair[0];
+    } else {
+        *--cursor = static_cast<char>('0' + magnitude);
+    }
+
+    size_t length = static_cast<size_t>(end - cursor);
+    memcpy(out, cursor, length);
+    return out + length;
+}
+
+// Streams the output.json array into one reusable buffer that is handed to
+// write() in large blocks. Records are formatted without locale lookups or
+// heap allocations, byte for byte like the original stringstream output.
+class JsonWriter {
+private:
+    std::vector<char> buffer;
+    size_t used;
+    size_t flushedBytes;
+    int fileDescriptor;
+    bool failed;
+
+public:
+    explicit JsonWriter(size_t capacity = JSON_BUFFER_SIZE)
+        : buffer(capacity < JSON_MAX_RECORD_SIZE ? JSON_MAX_RECORD_SIZE : capacity),
+          used(0), flushedBytes(0), fileDescriptor(-1), failed(false) {}
+
+    ~JsonWriter() { close(); }
+
+    bool open(const char* path) {
+        fileDescriptor = ::platform_open(path, OUTPUT_FILE_FLAGS, 0644);
+        failed = fileDescriptor < 0;
+        return !failed;
+    }
+
+    void beginArray() { append("[\n", 2); }
+
+    void writeMessage(const MarketMessage& message, bool isLast) {
+        if (buffer.size() - used < JSON_MAX_RECORD_SIZE) flush();
+
+        char* out = &buffer[used];
+        out = appendLiteral(out, "    {\n        \"assetCode\": \"");
+        size_t codeLength = strnlen(message.assetCode, 4);
+        memcpy(out, message.assetCode, codeLength);
+        out += codeLength;
+        out = appendLiteral(out, "\",\n        \"orderDirection\": \"");
+        *out++ = message.orderDirection;
+        out = appendLiteral(out, "\",\n        \"size\": ");
+        out = writeDecimal(out, message.size);
+        out = appendLiteral(out, ",\n        \"cost\": ");
+        out = writeDecimal(out, message.cost);
+        out = appendLiteral(out, ",\n        \"sequenceNum\": ");
+        out = writeDecimal(out, message.sequenceNum);
+        if (isLast) out = appendLiteral(out, "\n    }\n");
+        else out = appendLiteral(out, "\n    },\n");
+        used = static_cast<size_t>(out - &buffer[0]);
+    }
+
+    // Closes the array and writes out everything still buffered
+    bool endArray() {
+        append("]\n", 2);
+        return flush();
+    }
+
+    bool flush() {
+        size_t offset = 0;
+        while (!failed && offset < used) {
+            int written = ::platform_write(fileDescriptor, &buffer[offset],
+                                         static_cast<unsigned>(used - offset));
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                failed = true;
+                break;
+            }
+            offset += static_cast<size_t>(written);
+        }
+        flushedBytes += offset;
+        used = 0;
+        return !failed;
+    }
+
+    bool close() {
+        bool ok = flush();
+        if (fileDescriptor >= 0) {
+            ok = ::platform_close(fileDescriptor) == 0 && ok;
+            fileDescriptor = -1;
+        }
+        return ok;
+    }
+
+    size_t bytesWritten() const { return flushedBytes + used; }
+
+private:
+    template <size_t N>
+    static char* appendLiteral(char* out, const char (&text)[N]) {
+        memcpy(out, text, N - 1);
+        return out + N - 1;
+    }
+
+    void append(const char* text, size_t length) {
+        if (buffer.size() - used < length) flush();
+        memcpy(&buffer[used], text, length);
+        used += length;
+    }
+};
+
+#endif // ABX_JSON_WRITER_H
@@ -0,0 +1,78 @@
+#ifndef ABX_LATENCY_HISTOGRAM_H
+#define ABX_LATENCY_HISTOGRAM_H
+
+#include <cstdint>
+#include <cstring>
+
+// Fixed-size log-linear histogram of nanosecond latencies. Each power of
+// two is split into 16 linear sub-buckets (about 6% resolution), so
+// recording is a few bit operations and never allocates.
+class LatencyHistogram {
+public:
+    static const int SUB_BUCKET_BITS = 4;
+    static const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static const int BUCKET_COUNT = 64 * SUB_BUCKETS;
+
+private:
+    uint64_t counts[BUCKET_COUNT];
+    uint64_t total;
+    uint64_t maximum;
+
+public:
+    LatencyHistogram() { reset(); }
+
+    void reset() {
+        memset(counts, 0, sizeof(counts));
+        total = 0;
+        maximum = 0;
+    }
+
+    void record(uint64_t nanoseconds) {
+        ++counts[bucketFor(nanoseconds)];
+        ++total;
+        if (nanoseconds > maximum) maximum = nanoseconds;
+    }
+
+    uint64_t count() const { return total; }
+    uint64_t max() const { return maximum; }
+
+    // Upper bound of the bucket holding the given quantile (0..1)
+    uint64_t percentile(double quantile) const {
+        if (total == 0) return 0;
+        uint64_t rank = static_cast<uint64_t>(quantile * total);
+        if (rank >= total) rank = total - 1;
+        uint64_t seen = 0;
+        for (int bucket = 0; bucket < BUCKET_COUNT; ++bucket) {
+            seen += counts[bucket];
+            if (seen > rank) {
+                uint64_t upper = bucketUpperBound(bucket);
+                return upper < maximum ? upper : maximum;
+            }
+        }
+        return maximum;
+    }
+
+private:
+    static int highestBit(uint64_t value) {
+        int bit = 0;
+        while (value >>= 1) ++bit;
+        return bit;
+    }
+
+    static int bucketFor(uint64_t value) {
+        if (value < SUB_BUCKETS) return static_cast<int>(value);
+        int magnitude = highestBit(value);
+        int shift = magnitude - SUB_BUCKET_BITS;
+        int subBucket = static_cast<int>((value >> shift) & (SUB_BUCKETS - 1));
+        return (shift + 1) * SUB_BUCKETS + subBucket;
+    }
+
+    static uint64_t bucketUpperBound(int bucket) {
+        if (bucket < SUB_BUCKETS) return static_cast<uint64_t>(bucket);
+        int shift = bucket / SUB_BUCKETS - 1;
+        uint64_t subBucket = static_cast<uint64_t>(bucket % SUB_BUCKETS);
+        return (((uint64_t(SUB_BUCKETS) + subBucket + 1) << shift)) - 1;
+    }
+};
+
+#endif // ABX_LATENCY_HISTOGRAM_H
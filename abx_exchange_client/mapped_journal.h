@@ -0,0 +1,296 @@
+#ifndef ABX_MAPPED_JOURNAL_H
+#define ABX_MAPPED_JOURNAL_H
+
+#include "platform.h"
+#include "capture_journal.h"
+
+#include <algorithm>
+#include <climits>
+#include <vector>
+
+#ifndef _WIN32
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#endif
+
+const uint32_t JOURNAL_INDEX_STRIDE = 256;   // in-order records per sparse index sample
+
+// One journal record read in place from the mapping. Fields are decoded
+// from the packet bytes when asked for; nothing is copied up front. Valid
+// while the MappedJournal that produced it stays open.
+class JournalRecordView {
+private:
+    const uint8_t* packet;
+    const uint8_t* timestamp;
+
+public:
+    JournalRecordView() : packet(NULL), timestamp(NULL) {}
+    JournalRecordView(const uint8_t* packetBytes, const uint8_t* timestampBytes)
+        : packet(packetBytes), timestamp(timestampBytes) {}
+
+    int32_t sequenceNum() const { return readInt32BE(packet + 13); }
+    int32_t size() const { return readInt32BE(packet + 5); }
+    int32_t cost() const { return readInt32BE(packet + 9); }
+    char orderDirection() const { return static_cast<char>(packet[4]); }
+    uint64_t receivedAtNs() const { return readUInt64LE(timestamp); }
+
+    // The four asset code bytes, not NUL-terminated
+    const char* assetCodeBytes() const { return reinterpret_cast<const char*>(packet); }
+    const uint8_t* packetBytes() const { return packet; }
+
+    MarketMessage decode() const {
+        MarketMessage message;
+        decodePacket(packet, message);
+        return message;
+    }
+};
+
+// The records of one journal block. Packets are contiguous, so a whole
+// block can also be handed to decodePackets() at once.
+class JournalBlockView {
+private:
+    const uint8_t* block;
+    uint32_t records;
+
+public:
+    JournalBlockView(const uint8_t* blockBytes, uint32_t recordCount) : block(blockBytes), records(recordCount) {}
+
+    size_t size() const { return records; }
+    const uint8_t* packets() const { return block + JOURNAL_BLOCK_HEADER_SIZE; }
+
+    JournalRecordView record(size_t slot) const {
+        return JournalRecordView(block + JOURNAL_BLOCK_HEADER_SIZE + slot * PACKET_SIZE,
+                                 block + JOURNAL_TIMESTAMPS_OFFSET + slot * 8);
+    }
+
+    // Verifies the block checksum; reads every record byte of the block
+    bool intact() const { return readUInt32LE(block + 12) == journalBlockChecksum(block, records); }
+};
+
+// Access hints passed on to the kernel for the whole mapping
+enum class JournalAccess {
+    NORMAL,
+    SEQUENTIAL,   // aggressive read-ahead, pages dropped soon after use
+    RANDOM        // no read-ahead, for lookups by sequence
+};
+
+// Read-only memory mapping of a capture journal. open() walks the block
+// headers only (one cache line per 64 KiB block); record data is touched
+// when a view is read, so a scan runs at page-cache speed with no read()
+// copies. Checksums are checked per block with JournalBlockView::intact().
+//
+// Lookups by sequence go through a sparse index built on the first call.
+// Records that raise the highest sequence seen so far ("in order", the
+// bulk of any stream capture) form an ascending run, and only every
+// JOURNAL_INDEX_STRIDE-th of them is indexed; a lookup scans forward from
+// the nearest sample. Records that arrive behind the high-water mark
+// (resends, duplicates, reordering) are indexed individually.
+class MappedJournal {
+private:
+    struct IndexEntry {
+        int32_t sequenceNum;
+        uint32_t block;
+        uint32_t slot;
+
+        bool operator<(const IndexEntry& other) const { return sequenceNum < other.sequenceNum; }
+    };
+
+    const uint8_t* base;
+    size_t length;
+    #ifdef _WIN32
+        HANDLE fileHandle;
+        HANDLE mappingHandle;
+    #endif
+    std::vector<uint32_t> blockRecords;
+    std::vector<uint64_t> blockFirstRecord;
+    uint64_t recordTotal;
+    bool damagedTail;
+    bool indexed;
+    std::vector<IndexEntry> inOrderSamples;   // every JOURNAL_INDEX_STRIDE-th in-order record
+    std::vector<IndexEntry> outOfOrder;       // sorted by sequence
+
+public:
+    MappedJournal()
+        : base(NULL), length(0),
+          #ifdef _WIN32
+              fileHandle(INVALID_HANDLE_VALUE), mappingHandle(NULL),
+          #endif
+          recordTotal(0), damagedTail(false), indexed(false) {}
+    MappedJournal(const MappedJournal&) = delete;
+    MappedJournal& operator=(const MappedJournal&) = delete;
+    ~MappedJournal() { close(); }
+
+    // Maps a journal and reads its block headers. Blocks after the first
+    // malformed header, and a partial block at the end, are left out.
+    bool open(const char* path) {
+        close();
+        if (!mapFile(path)) return false;
+        if (length < JOURNAL_HEADER_SIZE || !journalHeaderValid(base)) {
+            close();
+            errno = EINVAL;
+            return false;
+        }
+
+        size_t blockCapacity = (length - JOURNAL_HEADER_SIZE) / JOURNAL_BLOCK_SIZE;
+        damagedTail = (length - JOURNAL_HEADER_SIZE) % JOURNAL_BLOCK_SIZE != 0;
+        for (size_t i = 0; i < blockCapacity; ++i) {
+            uint32_t records = journalBlockRecords(blockAt(i), static_cast<uint32_t>(i));
+            if (records == 0) {
+                damagedTail = true;
+                break;
+            }
+            blockFirstRecord.push_back(recordTotal);
+            blockRecords.push_back(records);
+            recordTotal += records;
+        }
+        return true;
+    }
+
+    void close() {
+        #ifdef _WIN32
+            if (base) UnmapViewOfFile(base);
+            if (mappingHandle) CloseHandle(mappingHandle);
+            if (fileHandle != INVALID_HANDLE_VALUE) CloseHandle(fileHandle);
+            mappingHandle = NULL;
+            fileHandle = INVALID_HANDLE_VALUE;
+        #else
+            if (base) munmap(const_cast<uint8_t*>(base), length);
+        #endif
+        base = NULL;
+        length = 0;
+        blockRecords.clear();
+        blockFirstRecord.clear();
+        recordTotal = 0;
+        damagedTail = false;
+        indexed = false;
+        inOrderSamples.clear();
+        outOfOrder.clear();
+    }
+
+    bool isOpen() const { return base != NULL; }
+    size_t blockCount() const { return blockRecords.size(); }
+    uint64_t recordCount() const { return recordTotal; }
+    size_t mappedBytes() const { return length; }
+
+    // True when the file continues past the last well-formed block
+    bool endedDamaged() const { return damagedTail; }
+
+    JournalBlockView block(size_t index) const { return JournalBlockView(blockAt(index), blockRecords[index]); }
+
+    // Record by position in the journal, 0 <= index < recordCount()
+    JournalRecordView record(uint64_t index) const {
+        size_t blockIndex = static_cast<size_t>(
+            std::upper_bound(blockFirstRecord.begin(), blockFirstRecord.end(), index) - blockFirstRecord.begin() - 1);
+        return block(blockIndex).record(static_cast<size_t>(index - blockFirstRecord[blockIndex]));
+    }
+
+    // Tells the kernel how the mapping is about to be read. Not available
+    // on Windows, where this is a no-op.
+    bool advise(JournalAccess access) const {
+        #ifdef _WIN32
+            (void)access;
+            return true;
+        #else
+            if (!base) return false;
+            int advice = access == JournalAccess::SEQUENTIAL ? POSIX_MADV_SEQUENTIAL
+                       : access == JournalAccess::RANDOM ? POSIX_MADV_RANDOM
+                       : POSIX_MADV_NORMAL;
+            return posix_madvise(const_cast<uint8_t*>(base), length, advice) == 0;
+        #endif
+    }
+
+    // Finds a record carrying seq: the in-order one when there is one,
+    // otherwise the earliest late arrival
+    bool findSequence(int32_t seq, JournalRecordView& view) {
+        if (!indexed) buildIndex();
+
+        std::vector<IndexEntry>::const_iterator sample = std::upper_bound(
+            inOrderSamples.begin(), inOrderSamples.end(), IndexEntry { seq, 0, 0 });
+        if (sample != inOrderSamples.begin() && scanInOrder(*(sample - 1), seq, view)) return true;
+
+        std::vector<IndexEntry>::const_iterator late = std::lower_bound(
+            outOfOrder.begin(), outOfOrder.end(), IndexEntry { seq, 0, 0 });
+        if (late == outOfOrder.end() || late->sequenceNum != seq) return false;
+        view = block(late->block).record(late->slot);
+        return true;
+    }
+
+    // Memory held by the sequence index
+    size_t indexBytes() const {
+        return (inOrderSamples.capacity() + outOfOrder.capacity()) * sizeof(IndexEntry);
+    }
+
+private:
+    const uint8_t* blockAt(size_t index) const { return base + JOURNAL_HEADER_SIZE + index * JOURNAL_BLOCK_SIZE; }
+
+    bool mapFile(const char* path) {
+        #ifdef _WIN32
+            fileHandle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+                                     OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+            LARGE_INTEGER fileSize;
+            if (fileHandle == INVALID_HANDLE_VALUE || !GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0) {
+                return false;
+            }
+            mappingHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+            if (!mappingHandle) return false;
+            base = static_cast<const uint8_t*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+            length = static_cast<size_t>(fileSize.QuadPart);
+            return base != NULL;
+        #else
+            int fd = ::open(path, O_RDONLY);
+            if (fd < 0) return false;
+            struct stat info;
+            if (fstat(fd, &info) != 0 || info.st_size == 0) {
+                ::close(fd);
+                return false;
+            }
+            void* mapping = mmap(NULL, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd);   // the mapping keeps the file referenced
+            if (mapping == MAP_FAILED) return false;
+            base = static_cast<const uint8_t*>(mapping);
+            length = static_cast<size_t>(info.st_size);
+            return true;
+        #endif
+    }
+
+    // One pass over every sequence number in the journal
+    void buildIndex() {
+        int32_t highest = INT32_MIN;
+        uint32_t inOrderCount = 0;
+        for (uint32_t b = 0; b < blockRecords.size(); ++b) {
+            JournalBlockView view = block(b);
+            for (uint32_t slot = 0; slot < view.size(); ++slot) {
+                IndexEntry entry = { view.record(slot).sequenceNum(), b, slot };
+                if (entry.sequenceNum > highest) {
+                    if (inOrderCount++ % JOURNAL_INDEX_STRIDE == 0) inOrderSamples.push_back(entry);
+                    highest = entry.sequenceNum;
+                } else {
+                    outOfOrder.push_back(entry);
+                }
+            }
+        }
+        std::stable_sort(outOfOrder.begin(), outOfOrder.end());
+        indexed = true;
+    }
+
+    // Walks the in-order run forward from a sample, skipping late arrivals
+    bool scanInOrder(const IndexEntry& from, int32_t seq, JournalRecordView& view) const {
+        int32_t highest = from.sequenceNum - 1;
+        for (uint32_t b = from.block; b < blockRecords.size(); ++b) {
+            JournalBlockView blockView = block(b);
+            for (uint32_t slot = b == from.block ? from.slot : 0; slot < blockView.size(); ++slot) {
+                int32_t current = blockView.record(slot).sequenceNum();
+                if (current <= highest) continue;
+                if (current == seq) {
+                    view = blockView.record(slot);
+                    return true;
+                }
+                if (current > seq) return false;
+                highest = current;
+            }
+        }
+        return false;
+    }
+};
+
+#endif // ABX_MAPPED_JOURNAL_H
@@ -0,0 +1,1368 @@
+#ifndef ABX_MARKET_DATA_CLIENT_H
+#define ABX_MARKET_DATA_CLIENT_H
+
+#include "platform.h"
+#include "wire_protocol.h"
+#include "utilities.h"
+#include "exchange_connection.h"
+#include "event_loop.h"
+#include "recovery_backlog.h"
+#include "retry_scheduler.h"
+#include "gap_tracker.h"
+#include "message_store.h"
+#include "columnar_store.h"
+#include "symbol_aggregator.h"
+#include "json_writer.h"
+#include "streaming_exporter.h"
+#include "async_logger.h"
+#include "latency_histogram.h"
+#include "spsc_ring.h"
+#include "capture_journal.h"
+#include "mapped_journal.h"
+
+#include <iostream>
+#include <vector>
+#include <set>
+#include <deque>
+#include <memory>
+#include <cstring>
+#include <algorithm>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <cstdlib>
+#include <string>
+
+// Constants
+const char* const DEFAULT_HOST_IP = "127.0.0.1";
+const int DEFAULT_HOST_PORT = 3000;
+const int LOADING_BAR_WIDTH = 50;
+const int PROGRESS_REDRAW_INTERVAL_MS = 100;
+const int DEFAULT_RECOVERY_WINDOW = 64;
+const int RECOVERY_TIMEOUT_MS = 2000;
+const int MAX_RECOVERY_ATTEMPTS = 3;
+const int MAX_REQUEST_EXPIRIES = 10;   // deadlines a sequence may miss on live connections
+const int DEFAULT_RECOVERY_CONNECTIONS = 1;
+const int EVENT_LOOP_TICK_MS = 100;   // longest wait between deadline checks
+const int RECOVERY_BACKOFF_BASE_MS = 50;    // first reconnect delay after a failure, before jitter
+const int RECOVERY_BACKOFF_MAX_MS = 1000;
+const int HANDSHAKE_TIMEOUT_MS = 500;
+const int CONNECT_TIMEOUT_MS = 2000;   // event-loop recovery connects still pending are given up
+const size_t RECEIVE_BATCH_MESSAGES = 1024;
+const size_t REPORT_TOP_SYMBOLS = 5;
+const size_t PIPELINE_RING_CAPACITY = 1 << 16;   // messages between the network and processing threads
+const char* const DEFAULT_OUTPUT_PATH = "output.json";
+
+// Runtime configuration for a client session
+struct ClientOptions {
+    int recoveryWindow;   // resend requests kept in flight on each recovery connection
+    int recoveryConnections;   // recovery connections open at once: worker threads, or event-loop sessions
+    double recoveryRate;  // resent sequences requested per second across all connections, 0 for no limit
+    bool eventLoop;       // drive the stream and every recovery connection from one epoll thread
+    bool ioUring;         // receive the stream through io_uring when the kernel supports it
+    bool streamExport;    // write output.json while data arrives instead of at the end
+    bool columnarStore;   // keep the session in ColumnarStore instead of MessageStore
+    bool verbose;         // log every received message instead of a per-second summary
+    bool measureLatency;  // time each stream packet from socket read to record stored
+    bool pipeline;        // split the stream into a network thread and a processing thread
+    bool pipelineDrop;    // drop instead of waiting when the pipeline ring is full
+    int networkCpu;       // CPU to pin the pipeline's network thread to, -1 for none
+    int processingCpu;    // CPU to pin the pipeline's processing thread to, -1 for none
+    std::string outputPath;
+    std::string aggregatesPath;   // per-symbol totals are written here when set
+    std::string journalPath;      // every processed packet is captured here when set
+    std::string columnarExportPath;   // columnar binary copy of output.json is written here when set
+    std::string replayPath;       // process this capture journal instead of connecting
+
+    ClientOptions()
+        : recoveryWindow(DEFAULT_RECOVERY_WINDOW), recoveryConnections(DEFAULT_RECOVERY_CONNECTIONS), recoveryRate(0),
+          eventLoop(false), ioUring(false), streamExport(false), columnarStore(false), verbose(false),
+          measureLatency(false), pipeline(false), pipelineDrop(false), networkCpu(-1), processingCpu(-1),
+          outputPath(DEFAULT_OUTPUT_PATH) {}
+};
+
+// Measurements of the last start() call, read back by benchmarks
+struct SessionStats {
+    uint64_t streamPackets;       // packets read from the stream connection, duplicates included
+    uint64_t streamBytes;
+    uint64_t streamReceiveSyscalls;   // recv() or io_uring_enter() calls on the stream connection
+    double streamSeconds;         // INITIAL_STREAM request to end of stream
+    double recoveryTailSeconds;   // end of stream to last gap closed or given up
+    int gapsOpened;
+    int missingCount;             // sequences found missing during the session
+    int recoveredCount;
+    int recoveryRetries;          // sequences requested again after a timeout or a failed connection
+    int recoveryTimeouts;         // requested sequences that passed their deadline unanswered
+    int recoveryGiveUps;          // sequences abandoned after too many failed attempts
+    double exportSeconds;         // writing output after recovery; the final flush for --stream-export
+    uint64_t exportBytes;
+    uint64_t columnarExportBytes;
+    size_t heldAfterRecovery;     // --stream-export records still waiting on a gap once recovery ended
+    uint64_t pipelineStalls;      // batches the network thread had to hold back on a full ring
+    uint64_t pipelineDropped;     // packets discarded on a full ring (--pipeline-drop)
+    uint64_t journalRecords;      // packets captured with --journal, or replayed with --replay
+    LatencyHistogram streamLatency;   // filled with --measure-latency
+
+    SessionStats()
+        : streamPackets(0), streamBytes(0), streamReceiveSyscalls(0), streamSeconds(0), recoveryTailSeconds(0),
+          gapsOpened(0), missingCount(0), recoveredCount(0), recoveryRetries(0), recoveryTimeouts(0),
+          recoveryGiveUps(0), exportSeconds(0), exportBytes(0), columnarExportBytes(0), heldAfterRecovery(0),
+          pipelineStalls(0), pipelineDropped(0), journalRecords(0) {}
+};
+
+// A decoded stream packet and the time its recv() completed
+struct ReceivedMessage {
+    MarketMessage message;
+    std::chrono::steady_clock::time_point readAt;
+};
+
+// Visual feedback component
+// The bar is redrawn only when its integer percentage changes, and at most
+// once per PROGRESS_REDRAW_INTERVAL_MS (100% is always drawn). It stays
+// silent when stdout is not a terminal. track() renders from a background
+// thread that polls a progress function, so the work loop itself never
+// touches the console.
+class LoadingIndicator {
+private:
+    int barWidth;
+    float percentComplete;
+    int drawnPercent;
+    bool enabled;
+    std::chrono::steady_clock::time_point lastDraw;
+    std::atomic<bool> tracking;
+    std::thread trackerThread;
+
+public:
+    explicit LoadingIndicator(int width = LOADING_BAR_WIDTH) 
+        : barWidth(width), percentComplete(0), drawnPercent(-1),
+          enabled(Utilities::stdoutIsTerminal()), tracking(false) {}
+
+    ~LoadingIndicator() {
+        stopTracking();
+    }
+
+    void show(float percent) {
+        percentComplete = std::min(1.0f, std::max(0.0f, percent));
+        int wholePercent = static_cast<int>(percentComplete * 100.0);
+        if (!enabled || wholePercent == drawnPercent) return;
+
+        auto now = std::chrono::steady_clock::now();
+        if (wholePercent < 100 && drawnPercent >= 0 &&
+            now - lastDraw < std::chrono::milliseconds(PROGRESS_REDRAW_INTERVAL_MS)) {
+            return;
+        }
+        lastDraw = now;
+        drawnPercent = wholePercent;
+        draw(wholePercent);
+    }
+
+    // Redraws from a background thread until stopTracking()
+    void track(std::function<float()> progress) {
+        if (!enabled || tracking.exchange(true)) return;
+        trackerThread = std::thread([this, progress] {
+            while (tracking.load()) {
+                show(progress());
+                std::this_thread::sleep_for(std::chrono::milliseconds(PROGRESS_REDRAW_INTERVAL_MS));
+            }
+            show(progress());
+        });
+    }
+
+    void stopTracking() {
+        if (!tracking.exchange(false)) return;
+        trackerThread.join();
+    }
+
+private:
+    void draw(int wholePercent) {
+        int filledWidth = static_cast<int>(barWidth * percentComplete);
+        std::string line = "\r[";
+        for (int i = 0; i < barWidth; ++i) {
+            if (i < filledWidth) line += '=';
+            else if (i == filledWidth) line += '>';
+            else line += ' ';
+        }
+        std::cout << line << "] " << wholePercent << "%" << std::flush;
+    }
+};
+
+// One recovery connection driven by the event loop
+struct RecoverySession {
+    enum State { IDLE, CONNECTING, NEGOTIATING, ACTIVE };
+
+    ExchangeConnection connection;
+    size_t token;             // the session's EventLoop token
+    State state;
+    bool watchingWritable;    // registered for writability: connecting, or a send is buffered
+    std::set<int> inFlight;   // requested and not yet answered
+    int answered;             // responses matched on the current connection
+    std::chrono::steady_clock::time_point deadline;   // when a silent or unfinished connection is given up
+    RequestDeadlines requestDeadlines;
+    RetryBackoff backoff;
+
+    explicit RecoverySession(size_t token)
+        : token(token), state(IDLE), watchingWritable(false), answered(0),
+          backoff(RECOVERY_BACKOFF_BASE_MS, RECOVERY_BACKOFF_MAX_MS, static_cast<unsigned>(token)) {}
+};
+
+class MarketDataClient {
+private:
+    #ifdef _WIN32
+        WSADATA wsaData;
+    #endif
+    ExchangeConnection streamConnection;
+
+    const char* hostIP;
+    const int hostPort;
+    ClientOptions options;
+    std::atomic<uint8_t> protocolVersion;   // negotiated resend encoding, 0 until negotiated
+    std::mutex negotiationMutex;            // lets one recovery worker negotiate at a time
+    MessageStore messageStore;                // batch export: whole session kept in memory
+    ColumnarStore columnarStore;              // batch export with --columnar-store
+    SymbolAggregator aggregator;
+    StreamingExporter streamingExporter;      // streaming export: only records waiting on a gap
+    ColumnarWriter columnarWriter;            // --columnar-export
+    GapTracker gapTracker;
+    AsyncLogger logger;
+    CaptureJournal captureJournal;            // --journal
+    std::chrono::steady_clock::time_point sessionStart;
+    int64_t sessionStartWallNs;               // sessionStart on the system clock, for journal timestamps
+    std::chrono::steady_clock::time_point streamStart;
+    std::chrono::steady_clock::time_point streamEnd;
+    SessionStats sessionStats;
+
+    // Shared between the stream and the recovery workers
+    std::mutex sessionMutex;   // guards the message stores, gapTracker, recoveryQueue and recoveryBacklog
+    std::condition_variable recoveryReady;
+    std::deque<SequenceRange> recoveryQueue;
+    RecoveryBacklog recoveryBacklog;   // gaps not yet requested, drawn on by every recovery connection
+    TokenBucket recoveryRate;          // --recovery-rate quota over requested sequences
+    bool streamFinished;
+    int recoveryWorkersRunning;
+    std::atomic<int> recoveredCount;
+
+    // Network Initialization
+    bool initializeNetworkStack() {
+        #ifdef _WIN32
+            int result = WSAStartup(MAKEWORD(2, 2), &wsaData);
+            if (result != 0) {
+                Utilities::printError(NetworkErrorType::SOCKET_CREATION, result);
+                return false;
+            }
+        #endif
+        return true;
+    }
+
+    void cleanupNetworkStack() {
+        #ifdef _WIN32
+            WSACleanup();
+        #endif
+    }
+
+    // Connection Management
+    bool connectToServer(ExchangeConnection& connection) {
+        if (!connection.connect(hostIP, hostPort)) return false;
+        logger.log(LogLevel::INFO, "[SUCCESS] Connected to data server");
+        return true;
+    }
+
+    // Data Transmission and Reception
+    bool sendCommand(ExchangeConnection& connection, CommandType commandCode) {
+        std::vector<uint8_t> commandBuffer;
+        appendCommand(commandBuffer, commandCode);
+        return connection.send(commandBuffer);
+    }
+
+    // Offers the range-capable encoding on the current connection. Legacy
+    // servers ignore or drop the unknown command; either way the session
+    // falls back to 2-byte commands and the caller must reconnect.
+    bool negotiateProtocol(ExchangeConnection& connection) {
+        std::vector<uint8_t> hello;
+        appendCommand(hello, CommandType::PROTOCOL_HELLO, PROTOCOL_VERSION_RANGES);
+        connection.setReceiveTimeout(HANDSHAKE_TIMEOUT_MS);
+
+        MarketMessage reply;
+        if (connection.send(hello) && receiveMessage(connection, reply)) {
+            acceptHandshake(reply);
+        } else {
+            protocolVersion = PROTOCOL_VERSION_LEGACY;
+        }
+        return protocolVersion == PROTOCOL_VERSION_RANGES;
+    }
+
+    void acceptHandshake(const MarketMessage& reply) {
+        protocolVersion = isHandshakePacket(reply) && reply.size >= PROTOCOL_VERSION_RANGES
+            ? PROTOCOL_VERSION_RANGES : PROTOCOL_VERSION_LEGACY;
+    }
+
+    bool receiveMessage(ExchangeConnection& connection, MarketMessage& message) {
+        return receiveMessages(connection, &message, 1) == 1;
+    }
+
+    // Blocking receive of up to maxCount messages. Returns 0 when the
+    // connection closed, timed out or failed.
+    size_t receiveMessages(ExchangeConnection& connection, MarketMessage* messages, size_t maxCount) {
+        size_t count;
+        return connection.receive(messages, maxCount, count) == ReceiveStatus::MESSAGES ? count : 0;
+    }
+
+    // Logging and Reporting
+    // Callers hold sessionMutex. Duplicates are dropped by the store, and a
+    // jump in sequence numbers is handed to the recovery thread straight away.
+    void logMessage(const MarketMessage& message) {
+        if (options.columnarStore && !options.streamExport) {
+            uint32_t symbolId;
+            if (!columnarStore.insert(message, &symbolId)) return;
+            aggregator.update(message, symbolId, columnarStore.symbols());
+        } else {
+            bool isNew = options.streamExport ? streamingExporter.add(message) : messageStore.insert(message);
+            if (!isNew) return;
+            aggregator.update(message);
+        }
+
+        SequenceRange newGap;
+        if (gapTracker.record(message.sequenceNum, newGap)) {
+            sessionStats.gapsOpened++;
+            recoveryQueue.push_back(newGap);
+            recoveryReady.notify_one();
+        }
+
+        logger.countMessage();
+        if (logger.enabled(LogLevel::DEBUG)) {
+            logger.log(LogLevel::DEBUG, "[RECEIVED] Message %d (%s)",
+                       message.sequenceNum, message.assetCode);
+        }
+    }
+
+    void generateSessionReport() {
+        auto currentTime = std::chrono::steady_clock::now();
+        auto totalRuntime = std::chrono::duration_cast<std::chrono::seconds>(
+            currentTime - sessionStart).count();
+    
+        std::cout << "\n[INFO] Session Report" << std::endl;
+        std::cout << "-----------------------------------" << std::endl;
+        std::cout << "Total Messages       : " << storedMessageCount() << std::endl;
+        std::cout << "Session Duration     : " << totalRuntime << "s" << std::endl;
+        std::cout << "Processing Rate      : " 
+                  << storedMessageCount() / (totalRuntime ? totalRuntime : 1) 
+                  << " msg/s" << std::endl;
+        if (options.streamExport) {
+            std::cout << "Peak Held Messages   : " << streamingExporter.peakHeld() << std::endl;
+            std::cout << "Held After Recovery  : " << sessionStats.heldAfterRecovery << std::endl;
+        } else if (options.columnarStore) {
+            std::cout << "Store Memory         : " << columnarStore.memoryBytes() / 1024 << " KiB" << std::endl;
+        }
+        if (!options.columnarExportPath.empty() && storedMessageCount() > 0) {
+            std::cout << "Columnar Export      : " << sessionStats.columnarExportBytes << " bytes ("
+                      << std::setprecision(3) << double(sessionStats.columnarExportBytes) / storedMessageCount()
+                      << " per message, JSON " << double(sessionStats.exportBytes) / storedMessageCount() << ")"
+                      << std::defaultfloat << std::setprecision(6) << std::endl;
+        }
+        if (options.pipeline) {
+            std::cout << "Pipeline Stalls      : " << sessionStats.pipelineStalls << std::endl;
+            std::cout << "Pipeline Drops       : " << sessionStats.pipelineDropped << std::endl;
+        }
+        if (!options.journalPath.empty()) {
+            std::cout << "Journal Records      : " << sessionStats.journalRecords
+                      << " (" << captureJournal.blockCount() << " blocks, "
+                      << captureJournal.checkpointCount() << " checkpoints)" << std::endl;
+        } else if (!options.replayPath.empty()) {
+            std::cout << "Journal Records      : " << sessionStats.journalRecords << " replayed" << std::endl;
+        }
+        if (sessionStats.missingCount > 0) {
+            std::cout << "Recovery Retries     : " << sessionStats.recoveryRetries
+                      << " (timeouts " << sessionStats.recoveryTimeouts
+                      << ", given up " << sessionStats.recoveryGiveUps << ")" << std::endl;
+        }
+        if (sessionStats.streamPackets > 0 && options.replayPath.empty()) {
+            std::cout << "Receive Syscalls     : " << sessionStats.streamReceiveSyscalls << " ("
+                      << std::setprecision(3)
+                      << double(sessionStats.streamReceiveSyscalls) / sessionStats.streamPackets
+                      << " per message" << (streamConnection.usingUring() ? ", io_uring" : "") << ")"
+                      << std::defaultfloat << std::setprecision(6) << std::endl;
+        }
+        if (sessionStats.streamLatency.count() > 0) {
+            const LatencyHistogram& latency = sessionStats.streamLatency;
+            std::cout << "Stream Latency (us)  : p50 " << latency.percentile(0.50) / 1000.0
+                      << ", p99 " << latency.percentile(0.99) / 1000.0
+                      << ", p999 " << latency.percentile(0.999) / 1000.0 << std::endl;
+        }
+        if (logger.dropped() > 0) {
+            std::cout << "Log Lines Dropped    : " << logger.dropped() << std::endl;
+        }
+
+        std::vector<SymbolTotals> symbols = aggregator.snapshot();
+        std::cout << "Symbols              : " << symbols.size() << std::endl;
+        for (size_t i = 0; i < symbols.size() && i < REPORT_TOP_SYMBOLS; ++i) {
+            std::cout << "  " << symbols[i].assetCode
+                      << "  volume " << symbols[i].volume
+                      << "  VWAP " << std::fixed << std::setprecision(2) << symbols[i].vwap()
+                      << "  imbalance " << std::showpos << symbols[i].imbalance()
+                      << std::noshowpos << std::defaultfloat << std::setprecision(6) << std::endl;
+        }
+    }
+
+    // Wall-clock nanoseconds since the epoch for a steady-clock read time
+    uint64_t captureTimestamp(std::chrono::steady_clock::time_point readAt) const {
+        return static_cast<uint64_t>(sessionStartWallNs +
+            std::chrono::duration_cast<std::chrono::nanoseconds>(readAt - sessionStart).count());
+    }
+
+    void recordStreamLatency(std::chrono::steady_clock::time_point readAt) {
+        sessionStats.streamLatency.record(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - readAt).count()));
+    }
+
+    size_t storedMessageCount() const {
+        if (options.streamExport) return streamingExporter.recordCount();
+        return options.columnarStore ? columnarStore.size() : messageStore.size();
+    }
+
+    // Data Recovery
+    // recoveryConnections workers, each on its own thread with its own
+    // long-lived connection, run for the whole session. Gaps are moved from
+    // recoveryQueue into the shared recoveryBacklog as soon as the stream
+    // reveals them, and each worker keeps up to recoveryWindow requested
+    // sequences outstanding, matched to responses by sequenceNum. With the
+    // v2 encoding a whole gap goes out as one range request. Requests a
+    // connection leaves unanswered when it closes or times out go back to
+    // the backlog for whichever worker has room next; a request is only
+    // charged an attempt when its connection produced no responses at all.
+    //
+    // Pacing: every request has a RECOVERY_TIMEOUT_MS deadline. Sequences
+    // that pass it while the connection keeps answering others were ignored
+    // by the server; they are requeued without dropping the connection and
+    // abandoned after MAX_REQUEST_EXPIRIES such misses. Only after a failed connection does the worker back off,
+    // with jitter, before reconnecting, and --recovery-rate caps requests
+    // across all workers. A healthy server therefore sees no added delay.
+    void runRecoveryWorker(unsigned workerId) {
+        ExchangeConnection connection;
+        std::set<int> inFlight, expired;
+        RequestDeadlines requestDeadlines;
+        RetryBackoff backoff(RECOVERY_BACKOFF_BASE_MS, RECOVERY_BACKOFF_MAX_MS, workerId + 1);
+        std::vector<uint8_t> commandBatch;
+        std::vector<SequenceRange> requestRanges;
+        int answeredOnConnection = 0, failedConnections = 0;
+        const int32_t window = std::max(1, options.recoveryWindow);
+
+        for (;;) {
+            // Collect newly detected gaps and take a share of the backlog,
+            // blocking only when there is nothing else to do
+            commandBatch.clear();
+            requestRanges.clear();
+            {
+                std::unique_lock<std::mutex> lock(sessionMutex);
+                collectGaps();
+                skipGivenUp();
+                if (inFlight.empty()) {
+                    while (recoveryBacklog.empty() && !streamFinished) {
+                        recoveryReady.wait(lock);
+                        collectGaps();
+                    }
+                    if (recoveryBacklog.empty()) {
+                        --recoveryWorkersRunning;
+                        return;
+                    }
+                }
+                if (connection.isOpen()) {
+                    auto now = std::chrono::steady_clock::now();
+                    int32_t room = recoveryRate.available(window - static_cast<int32_t>(inFlight.size()), now);
+                    recoveryRate.consume(recoveryBacklog.takeRequests(protocolVersion, room, commandBatch,
+                                                                      inFlight, &requestRanges));
+                    // Wake an idle worker for whatever this one had no room for
+                    if (!recoveryBacklog.empty()) recoveryReady.notify_one();
+                    if (inFlight.empty() && !recoveryBacklog.empty()) {
+                        recoveryReady.wait_until(lock, recoveryRate.nextTokenAt(now));
+                        continue;
+                    }
+                }
+            }
+
+            if (!connection.isOpen()) {
+                std::this_thread::sleep_until(backoff.nextAttemptAt());
+                if (!connectToServer(connection)) {
+                    logger.log(LogLevel::WARNING, " * Connection attempt failed");
+                    backoff.recordFailure(std::chrono::steady_clock::now());
+                    if (++failedConnections >= MAX_RECOVERY_ATTEMPTS) {
+                        leaveFailedRecovery();
+                        return;
+                    }
+                    continue;
+                }
+                failedConnections = 0;
+
+                bool legacyFallback = false;
+                {
+                    std::lock_guard<std::mutex> negotiation(negotiationMutex);
+                    if (protocolVersion == 0) legacyFallback = !negotiateProtocol(connection);
+                }
+                if (legacyFallback) {
+                    logger.log(LogLevel::INFO, "-> Server does not support range requests, using legacy commands");
+                    connection.close();
+                    continue;
+                }
+                connection.setReceiveTimeout(RECOVERY_TIMEOUT_MS);
+                answeredOnConnection = 0;
+                continue;
+            }
+            if (inFlight.empty()) continue;
+
+            ReceiveStatus status = ReceiveStatus::FAILED;
+            MarketMessage message;
+            size_t count;
+            if (!commandBatch.empty()) {
+                requestDeadlines.track(requestRanges, std::chrono::steady_clock::now() +
+                                       std::chrono::milliseconds(RECOVERY_TIMEOUT_MS));
+            }
+            if (commandBatch.empty() || connection.send(commandBatch)) {
+                status = connection.receive(&message, 1, count);
+            }
+            if (status == ReceiveStatus::MESSAGES) {
+                if (inFlight.erase(message.sequenceNum)) {
+                    answeredOnConnection++;
+                    backoff.recordSuccess();
+                    acceptRecovered(message, connection.lastReadAt());
+                }
+                // Requests the server skipped while still answering others
+                if (requestDeadlines.collectExpired(std::chrono::steady_clock::now(), inFlight, expired) > 0) {
+                    std::lock_guard<std::mutex> lock(sessionMutex);
+                    sessionStats.recoveryTimeouts += static_cast<int>(expired.size());
+                    recoveryBacklog.requeueExpired(expired);
+                    expired.clear();
+                }
+                continue;
+            }
+
+            // Connection closed or went silent: hand back what it left unanswered
+            connection.close();
+            requestDeadlines.clear();
+            backoff.recordFailure(std::chrono::steady_clock::now());
+            {
+                std::lock_guard<std::mutex> lock(sessionMutex);
+                if (status == ReceiveStatus::WOULD_BLOCK) {
+                    sessionStats.recoveryTimeouts += static_cast<int>(inFlight.size());
+                }
+                recoveryBacklog.requeue(inFlight, answeredOnConnection == 0);
+            }
+            inFlight.clear();
+            recoveryReady.notify_all();
+        }
+    }
+
+    // Called by a worker whose connections keep failing. When it is the
+    // last worker, whatever is still pending is abandoned, as the event
+    // loop does.
+    void leaveFailedRecovery() {
+        std::lock_guard<std::mutex> lock(sessionMutex);
+        if (--recoveryWorkersRunning > 0) return;
+        collectGaps();
+        if (recoveryBacklog.empty()) return;
+        logger.log(LogLevel::WARNING, " * Recovery connections keep failing, giving up");
+        abandonRecovery();
+    }
+
+    // Gives up on every pending gap; sessionMutex must be held
+    void abandonRecovery() {
+        recoveryBacklog.abandonAll();
+        skipGivenUp();
+    }
+
+    // Moves gaps found by the stream into the backlog; sessionMutex must be held
+    void collectGaps() {
+        recoveryBacklog.add(recoveryQueue.begin(), recoveryQueue.end());
+        recoveryQueue.clear();
+    }
+
+    // Lets the streaming export move past sequences recovery gave up on, so
+    // later records are not held back until the end of the session;
+    // sessionMutex must be held
+    void skipGivenUp() {
+        std::vector<SequenceRange> givenUp;
+        recoveryBacklog.takeGivenUp(givenUp);
+        if (!options.streamExport) return;
+        for (size_t i = 0; i < givenUp.size(); ++i) streamingExporter.skip(givenUp[i].start, givenUp[i].count);
+    }
+
+    // Stores a resent message if its sequence is still missing
+    void acceptRecovered(const MarketMessage& message, std::chrono::steady_clock::time_point readAt) {
+        if (captureJournal.isOpen()) captureJournal.append(&message, 1, captureTimestamp(readAt));
+        std::lock_guard<std::mutex> lock(sessionMutex);
+        if (gapTracker.isMissing(message.sequenceNum)) {
+            logMessage(message);
+            recoveredCount++;
+        }
+    }
+
+    void reportUnaddressable() {
+        if (recoveryBacklog.unaddressable() > 0) {
+            logger.log(LogLevel::WARNING, "! %d sequence numbers above %d cannot be requested from a legacy server",
+                       recoveryBacklog.unaddressable(), LEGACY_MAX_SEQUENCE);
+        }
+    }
+
+    // Event Loop
+    // Runs the whole session on the calling thread: the stream connection and
+    // up to recoveryConnections recovery sessions are non-blocking sockets
+    // registered with one EventLoop. Each recovery session keeps up to
+    // recoveryWindow sequences outstanding; all sessions draw from one
+    // RecoveryBacklog, so requests left behind by a failed or timed-out
+    // session are picked up by whichever session has room next.
+    void runEventLoop(LoadingIndicator& progress) {
+        EventLoop loop;
+        if (!loop.valid()) {
+            std::cerr << "* Could not create the event loop - aborting" << std::endl;
+            streamConnection.close();
+            return;
+        }
+
+        const size_t STREAM_TOKEN = 0;   // recovery session i uses token i + 1
+        std::vector<std::unique_ptr<RecoverySession> > sessions;
+        for (int i = 0; i < std::max(1, options.recoveryConnections); ++i) {
+            sessions.push_back(std::unique_ptr<RecoverySession>(new RecoverySession(i + 1)));
+        }
+        RecoveryBacklog& backlog = recoveryBacklog;
+        int failedConnections = 0;
+
+        streamConnection.setNonBlocking(true);
+        loop.add(streamConnection.pollHandle(), STREAM_TOKEN);
+
+        std::vector<MarketMessage> batch(RECEIVE_BATCH_MESSAGES);
+        std::vector<size_t> ready;
+        for (;;) {
+            {
+                std::lock_guard<std::mutex> lock(sessionMutex);
+                collectGaps();
+                skipGivenUp();
+            }
+
+            bool busy = false;
+            for (size_t i = 0; i < sessions.size(); ++i) {
+                RecoverySession& session = *sessions[i];
+                if (session.state == RecoverySession::IDLE && !backlog.empty() &&
+                    failedConnections < MAX_RECOVERY_ATTEMPTS &&
+                    std::chrono::steady_clock::now() >= session.backoff.nextAttemptAt()) {
+                    openSession(loop, session, sessions, failedConnections);
+                }
+                if (session.state == RecoverySession::ACTIVE) sendRequests(loop, session, backlog);
+                busy = busy || !session.inFlight.empty() || session.state == RecoverySession::CONNECTING ||
+                       session.state == RecoverySession::NEGOTIATING;
+            }
+            if (failedConnections >= MAX_RECOVERY_ATTEMPTS && !backlog.empty()) {
+                logger.log(LogLevel::WARNING, " * Recovery connections keep failing, giving up");
+                std::lock_guard<std::mutex> lock(sessionMutex);
+                abandonRecovery();
+            }
+            if (!streamConnection.isOpen() && !busy && backlog.empty()) break;
+
+            if (!loop.wait(nextWakeup(sessions, backlog), ready)) {
+                logger.log(LogLevel::ERROR, "* Event loop wait failed - aborting");
+                break;
+            }
+            for (size_t r = 0; r < ready.size(); ++r) {
+                if (ready[r] == STREAM_TOKEN) {
+                    if (streamConnection.isOpen() && !drainStream(loop, batch)) finishStream(progress);
+                } else {
+                    serviceSession(loop, *sessions[ready[r] - 1], backlog, batch, failedConnections);
+                }
+            }
+
+            // Connects that never finished and sessions whose server went quiet
+            // are closed and their requests requeued; requests a live session's
+            // server skipped are requeued alone
+            auto now = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < sessions.size(); ++i) {
+                RecoverySession& session = *sessions[i];
+                if (session.state != RecoverySession::IDLE && now >= session.deadline &&
+                    (session.state != RecoverySession::ACTIVE || !session.inFlight.empty())) {
+                    if (session.state == RecoverySession::CONNECTING) {
+                        abandonConnect(loop, session, failedConnections);
+                    } else if (session.state == RecoverySession::NEGOTIATING) {
+                        endNegotiation(loop, session, NULL);
+                    } else {
+                        sessionStats.recoveryTimeouts += static_cast<int>(session.inFlight.size());
+                        closeSession(loop, session, backlog);
+                    }
+                }
+                if (session.state == RecoverySession::ACTIVE) expireRequests(session, backlog, now);
+            }
+        }
+
+        if (streamConnection.isOpen()) {
+            loop.remove(streamConnection.pollHandle());
+            finishStream(progress);
+        }
+        for (size_t i = 0; i < sessions.size(); ++i) {
+            if (sessions[i]->state != RecoverySession::IDLE) closeSession(loop, *sessions[i], backlog);
+        }
+        reportUnaddressable();
+    }
+
+    // Reads the stream until the socket runs dry. Returns false once the
+    // stream has ended.
+    bool drainStream(EventLoop& loop, std::vector<MarketMessage>& batch) {
+        for (;;) {
+            size_t count;
+            ReceiveStatus status = streamConnection.receive(&batch[0], batch.size(), count);
+            if (status == ReceiveStatus::WOULD_BLOCK) return true;
+            if (status != ReceiveStatus::MESSAGES) {
+                loop.remove(streamConnection.pollHandle());
+                return false;
+            }
+            if (captureJournal.isOpen()) {
+                captureJournal.append(&batch[0], count, captureTimestamp(streamConnection.lastReadAt()));
+            }
+            std::lock_guard<std::mutex> lock(sessionMutex);
+            for (size_t i = 0; i < count; ++i) {
+                logMessage(batch[i]);
+                if (options.measureLatency) recordStreamLatency(streamConnection.lastReadAt());
+            }
+            sessionStats.streamPackets += count;
+        }
+    }
+
+    // Starts connecting an idle session without blocking the loop; a connect
+    // still in progress leaves the session CONNECTING until its socket turns
+    // writable. Only one session negotiates the protocol; the others wait
+    // until the version is known.
+    void openSession(EventLoop& loop, RecoverySession& session,
+                     const std::vector<std::unique_ptr<RecoverySession> >& sessions, int& failedConnections) {
+        if (protocolVersion == 0) {
+            for (size_t i = 0; i < sessions.size(); ++i) {
+                if (sessions[i]->state == RecoverySession::CONNECTING ||
+                    sessions[i]->state == RecoverySession::NEGOTIATING) return;
+            }
+        }
+        ConnectStatus status = session.connection.startConnect(hostIP, hostPort);
+        if (status == ConnectStatus::FAILED) {
+            recordConnectFailure(session, failedConnections);
+            return;
+        }
+        session.watchingWritable = status == ConnectStatus::IN_PROGRESS;
+        loop.add(session.connection.handle(), session.token, session.watchingWritable);
+        if (status == ConnectStatus::CONNECTED) {
+            startSession(loop, session, failedConnections);
+            return;
+        }
+        session.state = RecoverySession::CONNECTING;
+        session.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(CONNECT_TIMEOUT_MS);
+    }
+
+    // Handles readiness on a session's socket: a connect that finished,
+    // room for buffered commands, then replies
+    void serviceSession(EventLoop& loop, RecoverySession& session, RecoveryBacklog& backlog,
+                        std::vector<MarketMessage>& batch, int& failedConnections) {
+        if (session.state == RecoverySession::CONNECTING) {
+            if (!session.connection.finishConnect()) {
+                abandonConnect(loop, session, failedConnections);
+                return;
+            }
+            startSession(loop, session, failedConnections);
+        }
+        if (session.state != RecoverySession::IDLE && session.connection.sendPending()) {
+            if (!session.connection.flushSend()) {
+                if (session.state == RecoverySession::NEGOTIATING) endNegotiation(loop, session, NULL);
+                else closeSession(loop, session, backlog);
+                return;
+            }
+            watchPendingSend(loop, session);
+        }
+        drainSession(loop, session, backlog, batch);
+    }
+
+    // A connected session either starts requesting or, while the protocol
+    // version is unknown, sends the handshake
+    void startSession(EventLoop& loop, RecoverySession& session, int& failedConnections) {
+        logger.log(LogLevel::INFO, "[SUCCESS] Connected to data server");
+        failedConnections = 0;
+        session.answered = 0;
+
+        if (protocolVersion != 0) {
+            session.state = RecoverySession::ACTIVE;
+            watchPendingSend(loop, session);
+            return;
+        }
+        std::vector<uint8_t> hello;
+        appendCommand(hello, CommandType::PROTOCOL_HELLO, PROTOCOL_VERSION_RANGES);
+        session.state = RecoverySession::NEGOTIATING;
+        session.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(HANDSHAKE_TIMEOUT_MS);
+        if (!session.connection.send(hello)) {
+            endNegotiation(loop, session, NULL);
+            return;
+        }
+        watchPendingSend(loop, session);
+    }
+
+    // Closes a connect that failed or timed out
+    void abandonConnect(EventLoop& loop, RecoverySession& session, int& failedConnections) {
+        loop.remove(session.connection.handle());
+        session.connection.close();
+        session.state = RecoverySession::IDLE;
+        recordConnectFailure(session, failedConnections);
+    }
+
+    void recordConnectFailure(RecoverySession& session, int& failedConnections) {
+        logger.log(LogLevel::WARNING, " * Connection attempt failed");
+        session.backoff.recordFailure(std::chrono::steady_clock::now());
+        ++failedConnections;
+    }
+
+    // Watches the session's socket for writability exactly while it has
+    // bytes buffered that the send buffer could not take
+    void watchPendingSend(EventLoop& loop, RecoverySession& session) {
+        bool pending = session.connection.sendPending();
+        if (pending == session.watchingWritable) return;
+        loop.watchWritable(session.connection.handle(), session.token, pending);
+        session.watchingWritable = pending;
+    }
+
+    // Settles the protocol version from the handshake reply, or from its
+    // absence. A legacy server may have dropped the connection, so the
+    // session is closed and reconnects with the version known.
+    void endNegotiation(EventLoop& loop, RecoverySession& session, const MarketMessage* reply) {
+        if (reply) acceptHandshake(*reply);
+        else protocolVersion = PROTOCOL_VERSION_LEGACY;
+
+        if (protocolVersion == PROTOCOL_VERSION_RANGES) {
+            session.state = RecoverySession::ACTIVE;
+            return;
+        }
+        logger.log(LogLevel::INFO, "-> Server does not support range requests, using legacy commands");
+        loop.remove(session.connection.handle());
+        session.connection.close();
+        session.state = RecoverySession::IDLE;
+    }
+
+    // Tops the session up to recoveryWindow outstanding sequences
+    void sendRequests(EventLoop& loop, RecoverySession& session, RecoveryBacklog& backlog) {
+        auto now = std::chrono::steady_clock::now();
+        int32_t room = std::max(1, options.recoveryWindow) - static_cast<int32_t>(session.inFlight.size());
+        room = recoveryRate.available(room, now);
+        if (room <= 0 || backlog.empty()) return;
+
+        bool wasIdle = session.inFlight.empty();
+        std::vector<uint8_t> commands;
+        std::vector<SequenceRange> requestRanges;
+        recoveryRate.consume(backlog.takeRequests(protocolVersion, room, commands, session.inFlight, &requestRanges));
+        if (commands.empty()) return;
+        auto deadline = now + std::chrono::milliseconds(RECOVERY_TIMEOUT_MS);
+        session.requestDeadlines.track(requestRanges, deadline);
+        if (!session.connection.send(commands)) {
+            closeSession(loop, session, backlog);
+            return;
+        }
+        watchPendingSend(loop, session);
+        if (wasIdle) session.deadline = deadline;
+    }
+
+    void drainSession(EventLoop& loop, RecoverySession& session, RecoveryBacklog& backlog,
+                      std::vector<MarketMessage>& batch) {
+        while (session.state != RecoverySession::IDLE) {
+            size_t count;
+            size_t limit = session.state == RecoverySession::NEGOTIATING ? 1 : batch.size();
+            ReceiveStatus status = session.connection.receive(&batch[0], limit, count);
+            if (status == ReceiveStatus::WOULD_BLOCK) return;
+            if (status != ReceiveStatus::MESSAGES) {
+                if (session.state == RecoverySession::NEGOTIATING) endNegotiation(loop, session, NULL);
+                else closeSession(loop, session, backlog);
+                return;
+            }
+            if (session.state == RecoverySession::NEGOTIATING) {
+                endNegotiation(loop, session, &batch[0]);
+                continue;
+            }
+            for (size_t i = 0; i < count; ++i) {
+                if (!session.inFlight.erase(batch[i].sequenceNum)) continue;
+                session.answered++;
+                session.backoff.recordSuccess();
+                acceptRecovered(batch[i], session.connection.lastReadAt());
+            }
+            session.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(RECOVERY_TIMEOUT_MS);
+        }
+    }
+
+    // Requeues the sequences a live session's server let pass their deadline
+    void expireRequests(RecoverySession& session, RecoveryBacklog& backlog,
+                        std::chrono::steady_clock::time_point now) {
+        std::set<int> expired;
+        if (session.requestDeadlines.collectExpired(now, session.inFlight, expired) == 0) return;
+        sessionStats.recoveryTimeouts += static_cast<int>(expired.size());
+        backlog.requeueExpired(expired);
+    }
+
+    // Closes the session and hands its unanswered requests back to the
+    // backlog. Closing with requests outstanding counts as a failure for
+    // the session's backoff.
+    void closeSession(EventLoop& loop, RecoverySession& session, RecoveryBacklog& backlog) {
+        loop.remove(session.connection.handle());
+        session.connection.close();
+        if (!session.inFlight.empty()) session.backoff.recordFailure(std::chrono::steady_clock::now());
+        backlog.requeue(session.inFlight, session.answered == 0);
+        session.inFlight.clear();
+        session.requestDeadlines.clear();
+        session.state = RecoverySession::IDLE;
+    }
+
+    // Milliseconds until the earliest deadline, backoff expiry or rate-limit
+    // token, capped at EVENT_LOOP_TICK_MS
+    int nextWakeup(const std::vector<std::unique_ptr<RecoverySession> >& sessions, const RecoveryBacklog& backlog) {
+        auto now = std::chrono::steady_clock::now();
+        auto wakeAt = now + std::chrono::milliseconds(EVENT_LOOP_TICK_MS);
+        for (size_t i = 0; i < sessions.size(); ++i) {
+            RecoverySession& session = *sessions[i];
+            std::chrono::steady_clock::time_point requestDeadline;
+            if (session.state == RecoverySession::IDLE) {
+                if (!backlog.empty() && session.backoff.nextAttemptAt() > now) {
+                    wakeAt = std::min(wakeAt, session.backoff.nextAttemptAt());
+                }
+            } else if (session.state != RecoverySession::ACTIVE || !session.inFlight.empty()) {
+                wakeAt = std::min(wakeAt, session.deadline);
+            }
+            if (session.requestDeadlines.nextDeadline(session.inFlight, requestDeadline)) {
+                wakeAt = std::min(wakeAt, requestDeadline);
+            }
+        }
+        if (!backlog.empty() && recoveryRate.nextTokenAt(now) > now) {
+            wakeAt = std::min(wakeAt, recoveryRate.nextTokenAt(now));
+        }
+        long long remaining = std::chrono::duration_cast<std::chrono::milliseconds>(wakeAt - now).count();
+        return static_cast<int>(std::max(0LL, remaining + 1));
+    }
+
+    void printRecoveryResults(int missingCount, int recoveredCount, int maxSequence) {
+        if (recoveredCount == missingCount) {
+            std::cout << "\n+ COMPLETE: Successfully recovered all " 
+                      << missingCount << " missing messages!" << std::endl;
+        } else {
+            std::cout << "\n! NOTICE: Recovered " << recoveredCount 
+                      << " of " << missingCount << " missing messages." << std::endl;
+        }
+    
+        std::cout << "\nData Recovery Results:" << std::endl;
+        std::cout << "---------------------" << std::endl;
+        std::cout << "Total Expected Sequences: " << maxSequence << std::endl;
+        std::cout << "Missing Messages: " << missingCount << std::endl;
+        std::cout << "Successfully Recovered: " << recoveredCount << std::endl;
+        
+        if (missingCount > 0) {
+            std::cout << "Recovery Success Rate: " 
+                      << (recoveredCount * 100.0 / missingCount) << "%" << std::endl;
+        } else {
+            std::cout << "Recovery Success Rate: 100%" << std::endl;
+        }
+    }
+
+    // File Export
+    template <typename Store>
+    void exportToJSONFile(const Store& store) {
+        std::cout << "[INFO] Writing data to '" << options.outputPath << "'..." << std::endl;
+        
+        JsonWriter writer;
+        if (!writer.open(options.outputPath.c_str())) {
+            std::cerr << "[ERROR] Could not open " << options.outputPath << " for writing" << std::endl;
+            return;
+        }
+        writer.beginArray();
+        
+        LoadingIndicator progress;
+        size_t totalMessages = store.size();
+        size_t written = 0;
+        
+        // The store iterates in sequence order, so no sort is needed
+        store.forEach([&](const MarketMessage& message) {
+            ++written;
+            float completion = static_cast<float>(written) / totalMessages;  
+            progress.show(completion);
+            
+            bool isLast = (written == totalMessages);
+            writer.writeMessage(message, isLast);
+        });
+        
+        bool exported = writer.endArray() && writer.close();
+        sessionStats.exportBytes = writer.bytesWritten();
+        
+        progress.show(1.0);  
+        if (!exported) {
+            std::cerr << "\n[ERROR] Failed while writing " << options.outputPath << std::endl;
+            return;
+        }
+        std::cout << "\n[SUCCESS] Data export completed" << std::endl;
+    }
+
+    // Writes the store to the columnar export, in sequence order
+    template <typename Store>
+    void exportToColumnarFile(const Store& store) {
+        store.forEach([&](const MarketMessage& message) { columnarWriter.write(message); });
+        finishColumnarExport();
+    }
+
+    void finishColumnarExport() {
+        bool exported = columnarWriter.close();
+        sessionStats.columnarExportBytes = columnarWriter.bytesWritten();
+        if (!exported) {
+            std::cerr << "[ERROR] Failed while writing " << options.columnarExportPath << std::endl;
+            return;
+        }
+        std::cout << "[SUCCESS] Columnar export written to '" << options.columnarExportPath << "'" << std::endl;
+    }
+
+    // Stream Reception
+    // Reads, decodes and processes on the calling thread, one decoded batch per lock
+    void receiveStream() {
+        std::vector<MarketMessage> batch(RECEIVE_BATCH_MESSAGES);
+        size_t received;
+        while ((received = receiveMessages(streamConnection, &batch[0], batch.size())) > 0) {
+            if (captureJournal.isOpen()) {
+                captureJournal.append(&batch[0], received, captureTimestamp(streamConnection.lastReadAt()));
+            }
+            std::lock_guard<std::mutex> lock(sessionMutex);
+            for (size_t i = 0; i < received; ++i) {
+                logMessage(batch[i]);
+                if (options.measureLatency) recordStreamLatency(streamConnection.lastReadAt());
+            }
+            sessionStats.streamPackets += received;
+        }
+    }
+
+    // Same work split over two threads joined by an SPSC ring: the network
+    // thread only reads and decodes, the processing thread tracks sequences,
+    // aggregates and stores. A full ring either stalls the network thread or,
+    // with pipelineDrop, discards the rest of the batch; discarded packets
+    // show up as gaps and are fetched again by the recovery thread, unless
+    // they were the very last of the stream.
+    void receiveStreamPipelined() {
+        SpscRing<ReceivedMessage> ring(PIPELINE_RING_CAPACITY);
+        std::atomic<bool> networkDone(false);
+        uint64_t received = 0, stalls = 0, dropped = 0;
+
+        std::thread networkThread([&] {
+            if (options.networkCpu >= 0 && !pinCurrentThread(options.networkCpu)) {
+                logger.log(LogLevel::WARNING, "! Could not pin the network thread to CPU %d", options.networkCpu);
+            }
+            std::vector<MarketMessage> decoded(RECEIVE_BATCH_MESSAGES);
+            std::vector<ReceivedMessage> staged(RECEIVE_BATCH_MESSAGES);
+            size_t count;
+            while ((count = receiveMessages(streamConnection, &decoded[0], decoded.size())) > 0) {
+                received += count;
+                for (size_t i = 0; i < count; ++i) {
+                    staged[i].message = decoded[i];
+                    staged[i].readAt = streamConnection.lastReadAt();
+                }
+                size_t pushed = ring.pushBatch(&staged[0], count);
+                if (pushed == count) continue;
+                if (options.pipelineDrop) {
+                    dropped += count - pushed;
+                    continue;
+                }
+                ++stalls;
+                while (pushed < count) {
+                    std::this_thread::yield();
+                    pushed += ring.pushBatch(&staged[pushed], count - pushed);
+                }
+            }
+            networkDone.store(true, std::memory_order_release);
+        });
+
+        std::thread processingThread([&] {
+            if (options.processingCpu >= 0 && !pinCurrentThread(options.processingCpu)) {
+                logger.log(LogLevel::WARNING, "! Could not pin the processing thread to CPU %d", options.processingCpu);
+            }
+            std::vector<ReceivedMessage> batch(RECEIVE_BATCH_MESSAGES);
+            std::vector<MarketMessage> journalBatch(captureJournal.isOpen() ? RECEIVE_BATCH_MESSAGES : 0);
+            std::vector<uint64_t> journalTimes(journalBatch.size());
+            for (;;) {
+                size_t count = ring.popBatch(&batch[0], batch.size());
+                if (count == 0) {
+                    if (networkDone.load(std::memory_order_acquire) && ring.size() == 0) break;
+                    std::this_thread::yield();
+                    continue;
+                }
+                if (!journalBatch.empty()) {
+                    for (size_t i = 0; i < count; ++i) {
+                        journalBatch[i] = batch[i].message;
+                        journalTimes[i] = captureTimestamp(batch[i].readAt);
+                    }
+                    captureJournal.append(&journalBatch[0], &journalTimes[0], count);
+                }
+                std::lock_guard<std::mutex> lock(sessionMutex);
+                for (size_t i = 0; i < count; ++i) {
+                    logMessage(batch[i].message);
+                    if (options.measureLatency) recordStreamLatency(batch[i].readAt);
+                }
+            }
+        });
+
+        networkThread.join();
+        processingThread.join();
+        sessionStats.streamPackets += received;
+        sessionStats.pipelineStalls = stalls;
+        sessionStats.pipelineDropped = dropped;
+    }
+
+    // Closes the stream, hands the end-of-stream state to recovery and
+    // starts the progress bar for whatever is still outstanding
+    void finishStream(LoadingIndicator& progress) {
+        streamEnd = std::chrono::steady_clock::now();
+        sessionStats.streamSeconds = std::chrono::duration<double>(streamEnd - streamStart).count();
+        sessionStats.streamBytes = sessionStats.streamPackets * PACKET_SIZE;
+        sessionStats.streamReceiveSyscalls = streamConnection.receiveSyscallCount();
+        streamConnection.close();
+        logger.log(LogLevel::INFO, "\n+ Initial data stream complete");
+
+        int outstandingAtStreamEnd, recoveredAtStreamEnd;
+        {
+            std::lock_guard<std::mutex> lock(sessionMutex);
+            logger.log(LogLevel::INFO, "\n-> Validating data integrity... %lld sequence numbers outstanding in %d gaps",
+                       static_cast<long long>(gapTracker.missingCount()),
+                       static_cast<int>(gapTracker.openGapCount()));
+            streamFinished = true;
+            outstandingAtStreamEnd = static_cast<int>(gapTracker.missingCount());
+            recoveredAtStreamEnd = recoveredCount.load();
+        }
+        recoveryReady.notify_all();
+
+        if (outstandingAtStreamEnd > 0) {
+            progress.track([this, outstandingAtStreamEnd, recoveredAtStreamEnd] {
+                return float(recoveredCount.load() - recoveredAtStreamEnd) / outstandingAtStreamEnd;
+            });
+        }
+    }
+
+    // Replay
+    // Feeds a capture journal through the same processing path as the live
+    // stream, decoding each block straight from the memory-mapped file.
+    // Nothing is requested from a server: a record that fills an open gap
+    // counts as recovered, and sequences the journal never saw stay
+    // unrecovered. Replay stops at the first damaged block, keeping
+    // everything before it.
+    bool replayJournal() {
+        MappedJournal journal;
+        if (!journal.open(options.replayPath.c_str())) {
+            logger.log(LogLevel::ERROR, "* Could not read journal '%s': %s", options.replayPath.c_str(), strerror(errno));
+            return false;
+        }
+        journal.advise(JournalAccess::SEQUENTIAL);
+        logger.log(LogLevel::INFO, "-> Replaying journal '%s'...", options.replayPath.c_str());
+
+        streamStart = std::chrono::steady_clock::now();
+        std::vector<MarketMessage> batch(JOURNAL_BLOCK_RECORDS);
+        size_t replayedBlocks = 0;
+        for (; replayedBlocks < journal.blockCount(); ++replayedBlocks) {
+            JournalBlockView block = journal.block(replayedBlocks);
+            if (!block.intact()) break;
+            decodePackets(block.packets(), block.size(), &batch[0]);
+            std::lock_guard<std::mutex> lock(sessionMutex);
+            for (size_t i = 0; i < block.size(); ++i) {
+                if (gapTracker.isMissing(batch[i].sequenceNum)) recoveredCount++;
+                logMessage(batch[i]);
+            }
+            sessionStats.streamPackets += block.size();
+        }
+        recoveryQueue.clear();
+        streamEnd = std::chrono::steady_clock::now();
+        sessionStats.streamSeconds = std::chrono::duration<double>(streamEnd - streamStart).count();
+        sessionStats.streamBytes = sessionStats.streamPackets * PACKET_SIZE;
+        sessionStats.journalRecords = sessionStats.streamPackets;
+
+        if (replayedBlocks < journal.blockCount()) {
+            logger.log(LogLevel::WARNING, "! Journal block %u failed its checksum, replayed the blocks before it",
+                       static_cast<unsigned>(replayedBlocks));
+        } else if (journal.endedDamaged()) {
+            logger.log(LogLevel::WARNING, "! Journal ends in a damaged block after %u intact blocks",
+                       static_cast<unsigned>(replayedBlocks));
+        }
+        logger.log(LogLevel::INFO, "\n+ Journal replay complete: %llu records",
+                   static_cast<unsigned long long>(sessionStats.streamPackets));
+        logger.log(LogLevel::INFO, "\n-> Validating data integrity... %lld sequence numbers outstanding in %d gaps",
+                   static_cast<long long>(gapTracker.missingCount()),
+                   static_cast<int>(gapTracker.openGapCount()));
+        return true;
+    }
+
+    // Syncs and closes the capture journal once nothing more can arrive
+    void finishJournal() {
+        sessionStats.journalRecords = captureJournal.recordCount();
+        if (!captureJournal.close()) {
+            std::cerr << "[ERROR] Failed while writing journal " << options.journalPath << std::endl;
+            return;
+        }
+        std::cout << "[SUCCESS] Journal of " << sessionStats.journalRecords << " records written to '"
+                  << options.journalPath << "'" << std::endl;
+    }
+
+    // Shuts down what start() set up when the session ends before any data
+    // arrived: the logger writes out its queue, the journal gets its final
+    // checkpoint, and the export files are closed complete rather than cut off
+    void abortSession() {
+        logger.stop();
+        if (captureJournal.isOpen()) finishJournal();
+        if (options.streamExport) streamingExporter.finish();
+        if (columnarWriter.isOpen()) columnarWriter.close();
+    }
+
+    // Connects, receives the stream and recovers its gaps. Returns false
+    // when the server could not be reached.
+    bool receiveSession(LoadingIndicator& progress) {
+        if (!connectToServer(streamConnection)) {
+            logger.log(LogLevel::ERROR, "* Initial connection failed - aborting");
+            return false;
+        }
+        if (options.ioUring) {
+            if (streamConnection.useUring()) {
+                logger.log(LogLevel::INFO, "-> Receiving the stream through io_uring");
+            } else {
+                logger.log(LogLevel::WARNING, "! io_uring unavailable (%s), receiving with recv()",
+                           strerror(streamConnection.uringError()));
+            }
+        }
+
+        logger.log(LogLevel::INFO, "-> Requesting initial data stream...");
+        streamStart = std::chrono::steady_clock::now();
+        sendCommand(streamConnection, CommandType::INITIAL_STREAM);
+
+        if (options.eventLoop) {
+            runEventLoop(progress);
+        } else {
+            // Gaps are recovered on separate connections while the stream is still running
+            std::vector<std::thread> recoveryWorkers;
+            recoveryWorkersRunning = std::max(1, options.recoveryConnections);
+            for (int i = 0; i < recoveryWorkersRunning; ++i) {
+                recoveryWorkers.push_back(std::thread(&MarketDataClient::runRecoveryWorker, this, unsigned(i)));
+            }
+            if (options.pipeline) receiveStreamPipelined();
+            else receiveStream();
+            finishStream(progress);
+            for (size_t i = 0; i < recoveryWorkers.size(); ++i) recoveryWorkers[i].join();
+            {
+                // Gaps the stream found after every worker had given up
+                std::lock_guard<std::mutex> lock(sessionMutex);
+                collectGaps();
+                abandonRecovery();
+            }
+            reportUnaddressable();
+        }
+        return true;
+    }
+
+    // Writes out what the streaming exporter still holds and closes the file
+    void finishStreamingExport() {
+        std::cout << "[INFO] Completing '" << options.outputPath << "'..." << std::endl;
+        {
+            std::lock_guard<std::mutex> lock(sessionMutex);
+            skipGivenUp();
+            sessionStats.heldAfterRecovery = streamingExporter.held();
+        }
+        bool exported = streamingExporter.finish();
+        sessionStats.exportBytes = streamingExporter.bytesWritten();
+        if (!exported) {
+            std::cerr << "[ERROR] Failed while writing " << options.outputPath << std::endl;
+            return;
+        }
+        std::cout << "[SUCCESS] Data export completed" << std::endl;
+    }
+
+public:
+    // Constructor and Destructor
+    MarketDataClient(
+        const char* ip = DEFAULT_HOST_IP, 
+        int port = DEFAULT_HOST_PORT,
+        const ClientOptions& clientOptions = ClientOptions()
+    ) : hostIP(ip), hostPort(port), options(clientOptions), protocolVersion(0), sessionStartWallNs(0),
+        recoveryBacklog(MAX_RECOVERY_ATTEMPTS, MAX_REQUEST_EXPIRIES),
+        recoveryRate(clientOptions.recoveryRate,
+                     std::max(1, clientOptions.recoveryWindow) * std::max(1, clientOptions.recoveryConnections)),
+        streamFinished(false), recoveryWorkersRunning(0), recoveredCount(0) {
+        if (!initializeNetworkStack()) {
+            throw std::runtime_error("Network stack initialization failed");
+        }
+    }
+
+    ~MarketDataClient() {
+        cleanupNetworkStack();
+    }
+
+    const SessionStats& stats() const { return sessionStats; }
+
+    // Main process method
+    void start() {
+        sessionStart = std::chrono::steady_clock::now();
+        sessionStartWallNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        
+        if (options.streamExport) {
+            if (!streamingExporter.open(options.outputPath.c_str())) {
+                std::cerr << "* Could not open " << options.outputPath << " for writing - aborting" << std::endl;
+                return;
+            }
+            std::cout << "[INFO] Streaming data to '" << options.outputPath << "' as it arrives" << std::endl;
+        }
+        if (!options.columnarExportPath.empty()) {
+            if (!columnarWriter.open(options.columnarExportPath.c_str())) {
+                std::cerr << "* Could not open " << options.columnarExportPath << " for writing - aborting" << std::endl;
+                abortSession();
+                return;
+            }
+            if (options.streamExport) streamingExporter.alsoWriteTo(&columnarWriter);
+        }
+
+        // Console output goes through the logger while the connections are live
+        logger.setLevel(options.verbose ? LogLevel::DEBUG : LogLevel::INFO);
+        logger.start(!options.verbose);
+
+        if (!options.journalPath.empty()) {
+            if (!captureJournal.open(options.journalPath.c_str(), static_cast<uint64_t>(sessionStartWallNs))) {
+                std::cerr << "* Could not open journal " << options.journalPath << " - aborting" << std::endl;
+                abortSession();
+                return;
+            }
+            logger.log(LogLevel::INFO, "-> Capturing packets to '%s'", options.journalPath.c_str());
+        }
+
+        LoadingIndicator progress;
+        bool received = options.replayPath.empty() ? receiveSession(progress) : replayJournal();
+        if (!received) {
+            abortSession();
+            return;
+        }
+        progress.stopTracking();
+        logger.stop();
+        auto recoveryEnd = std::chrono::steady_clock::now();
+        if (captureJournal.isOpen()) finishJournal();
+        sessionStats.recoveryTailSeconds = std::chrono::duration<double>(recoveryEnd - streamEnd).count();
+        sessionStats.recoveredCount = recoveredCount;
+        sessionStats.recoveryRetries = recoveryBacklog.requeued();
+        sessionStats.recoveryGiveUps = recoveryBacklog.abandoned();
+        sessionStats.missingCount = recoveredCount + static_cast<int>(gapTracker.missingCount());
+
+        printRecoveryResults(sessionStats.missingCount, recoveredCount, gapTracker.highest());
+
+        // Export Data
+        if (options.streamExport) finishStreamingExport();
+        else if (options.columnarStore) exportToJSONFile(columnarStore);
+        else exportToJSONFile(messageStore);
+        if (columnarWriter.isOpen()) {
+            if (options.streamExport) finishColumnarExport();
+            else if (options.columnarStore) exportToColumnarFile(columnarStore);
+            else exportToColumnarFile(messageStore);
+        }
+        sessionStats.exportSeconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - recoveryEnd).count();
+        if (!options.aggregatesPath.empty()) {
+            if (aggregator.exportToJSON(options.aggregatesPath.c_str())) {
+                std::cout << "[SUCCESS] Symbol totals written to '" << options.aggregatesPath << "'" << std::endl;
+            } else {
+                std::cerr << "[ERROR] Could not write " << options.aggregatesPath << std::endl;
+            }
+        }
+        generateSessionReport();
+        
+        std::cout << "\n+ Process complete! Data saved to " << options.outputPath << "\n" << std::endl;
+    }
+};
+
+#endif // ABX_MARKET_DATA_CLIENT_H
@@ -0,0 +1,61 @@
+#ifndef ABX_MESSAGE_STORE_H
+#define ABX_MESSAGE_STORE_H
+
+#include "wire_protocol.h"
+#include "sequence_index.h"
+
+#include <memory>
+#include <vector>
+
+// Messages stored directly in the slot for their sequence number. Slots
+// live in fixed-size pages that are allocated on first use, so the store
+// grows with the highest sequence seen without ever moving a message.
+// Iteration is in sequence order, so nothing needs sorting before export,
+// and a SequenceIndex records which slots are filled so duplicates are
+// rejected on insert.
+class MessageStore {
+public:
+    static const int32_t PAGE_MESSAGES = 1 << 16;
+
+private:
+    std::vector<std::unique_ptr<MarketMessage[]> > pages;
+    SequenceIndex presentSequences;
+
+public:
+    // Stores a message in its slot. Returns false for a duplicate or an
+    // invalid sequence number, leaving the stored message untouched.
+    bool insert(const MarketMessage& message) {
+        int32_t seq = message.sequenceNum;
+        if (!presentSequences.insert(seq)) return false;
+
+        size_t pageIndex = static_cast<size_t>(seq / PAGE_MESSAGES);
+        if (pageIndex >= pages.size()) pages.resize(pageIndex + 1);
+        if (!pages[pageIndex]) pages[pageIndex].reset(new MarketMessage[PAGE_MESSAGES]);
+        pages[pageIndex][seq % PAGE_MESSAGES] = message;
+        return true;
+    }
+
+    bool contains(int32_t seq) const { return presentSequences.contains(seq); }
+
+    // Stored message for seq, or NULL if it has not arrived
+    const MarketMessage* find(int32_t seq) const {
+        if (!contains(seq)) return NULL;
+        return &pages[seq / PAGE_MESSAGES][seq % PAGE_MESSAGES];
+    }
+
+    size_t size() const { return static_cast<size_t>(presentSequences.size()); }
+    int32_t highest() const { return presentSequences.highest(); }
+    const SequenceIndex& sequences() const { return presentSequences; }
+
+    // Calls visit(const MarketMessage&) for every stored message in sequence order
+    template <typename Visitor>
+    void forEach(Visitor visit) const {
+        int32_t highestSequence = presentSequences.highest();
+        for (int32_t seq = 1; seq <= highestSequence; ++seq) {
+            const MarketMessage* message = find(seq);
+            if (message) visit(*message);
+        }
+    }
+};
+
+#endif // ABX_MESSAGE_STORE_H
@@ -0,0 +1,75 @@
+#ifndef ABX_PACKET_DECODER_H
+#define ABX_PACKET_DECODER_H
+
+#include "wire_protocol.h"
+
+#include <cstddef>
+
+// The SIMD decoder is built with a per-function target attribute and picked
+// at runtime, so the binary still runs on CPUs without SSSE3. Other
+// compilers and architectures use the scalar decoder only. Each record is
+// written with one 16-byte store, so a two-lane AVX2 version gains nothing
+// and measured slower because of the lane insert/extract.
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    #define ABX_X86_SIMD_DECODE 1
+    #include <immintrin.h>
+#endif
+
+// Decodes count contiguous 17-byte packets into messages
+typedef void (*BatchDecodeFunction)(const uint8_t* packets, size_t count, MarketMessage* messages);
+
+struct BatchDecoder {
+    const char* name;
+    BatchDecodeFunction decode;
+};
+
+inline void decodePacketsScalar(const uint8_t* packets, size_t count, MarketMessage* messages) {
+    for (size_t i = 0; i < count; ++i) decodePacket(packets + i * PACKET_SIZE, messages[i]);
+}
+
+#ifdef ABX_X86_SIMD_DECODE
+
+// The shuffle writes bytes 4..19 of MarketMessage in one 16-byte store, so
+// it depends on the struct having no other padding than after orderDirection
+static_assert(offsetof(MarketMessage, orderDirection) == 5 && offsetof(MarketMessage, size) == 8 &&
+              offsetof(MarketMessage, cost) == 12 && offsetof(MarketMessage, sequenceNum) == 16 &&
+              sizeof(MarketMessage) == 20, "MarketMessage layout assumed by the SIMD decoder");
+
+// Maps packet bytes 1..16 onto MarketMessage bytes 4..19: the assetCode
+// terminator and padding become zero and the three big-endian fields are
+// byte-swapped in place. Index -1 zeroes the output byte.
+__attribute__((target("ssse3")))
+inline void decodePacketsSsse3(const uint8_t* packets, size_t count, MarketMessage* messages) {
+    const __m128i shuffle = _mm_setr_epi8(-1, 3, -1, -1,  7, 6, 5, 4,  11, 10, 9, 8,  15, 14, 13, 12);
+    for (size_t i = 0; i < count; ++i) {
+        const uint8_t* packet = packets + i * PACKET_SIZE;
+        char* out = reinterpret_cast<char*>(&messages[i]);
+        __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i*>(packet + 1));
+        memcpy(out, packet, 4);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4), _mm_shuffle_epi8(tail, shuffle));
+    }
+}
+
+#endif // ABX_X86_SIMD_DECODE
+
+// Fastest decoder this CPU supports, chosen on first use
+inline const BatchDecoder& selectedBatchDecoder() {
+    static const BatchDecoder decoder = [] {
+        BatchDecoder choice = { "scalar", decodePacketsScalar };
+        #ifdef ABX_X86_SIMD_DECODE
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("ssse3")) {
+                choice.name = "ssse3";
+                choice.decode = decodePacketsSsse3;
+            }
+        #endif
+        return choice;
+    }();
+    return decoder;
+}
+
+inline void decodePackets(const uint8_t* packets, size_t count, MarketMessage* messages) {
+    selectedBatchDecoder().decode(packets, count, messages);
+}
+
+#endif // ABX_PACKET_DECODER_H
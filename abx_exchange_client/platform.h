@@ -0,0 +1,54 @@
+#ifndef ABX_PLATFORM_H
+#define ABX_PLATFORM_H
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define delay_milliseconds(x) Sleep(x)
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+    #include <windows.h>
+#else
+    #include <arpa/inet.h>
+    #include <sys/socket.h>
+    #include <unistd.h>
+    #define delay_milliseconds(x) usleep(x*1000)
+#endif
+
+#include <errno.h>
+
+// send() flag that turns a write to a closed peer into an error instead of SIGPIPE
+#if defined(MSG_NOSIGNAL)
+    const int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+    const int SEND_FLAGS = 0;
+#endif
+
+// Native socket handle type for the current platform
+#ifdef _WIN32
+    typedef SOCKET SocketHandle;
+#else
+    typedef int SocketHandle;
+#endif
+
+// Restricts the calling thread to one CPU. Returns false where thread
+// affinity is not supported or the CPU does not exist.
+#if defined(_WIN32)
+    inline bool pinCurrentThread(int cpu) {
+        if (cpu < 0 || cpu >= static_cast<int>(sizeof(DWORD_PTR) * 8)) return false;
+        return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << cpu) != 0;
+    }
+#elif defined(__linux__)
+    #include <pthread.h>
+    #include <sched.h>
+    inline bool pinCurrentThread(int cpu) {
+        if (cpu < 0 || cpu >= CPU_SETSIZE) return false;
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(cpu, &cpus);
+        return pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0;
+    }
+#else
+    inline bool pinCurrentThread(int) { return false; }
+#endif
+
+#endif // ABX_PLATFORM_H
@@ -0,0 +1,89 @@
+#ifndef ABX_RECEIVE_BUFFER_H
+#define ABX_RECEIVE_BUFFER_H
+
+#include "platform.h"
+#include "wire_protocol.h"
+#include "packet_decoder.h"
+
+#include <algorithm>
+#include <vector>
+
+const size_t RECEIVE_BUFFER_SIZE = 64 * 1024;
+
+// Bulk receive buffer: one recv() pulls in as many packets as the socket has
+// ready, and complete packets are then decoded straight out of the buffer.
+// A partial packet left at the end of a read is moved to the front and
+// completed by the next read.
+class ReceiveBuffer {
+private:
+    std::vector<uint8_t> storage;
+    size_t readOffset;
+    size_t writeOffset;
+    size_t receiveCalls;
+
+public:
+    explicit ReceiveBuffer(size_t capacity = RECEIVE_BUFFER_SIZE)
+        : storage(capacity < PACKET_SIZE ? PACKET_SIZE : capacity),
+          readOffset(0), writeOffset(0), receiveCalls(0) {}
+
+    // Drops any buffered bytes, e.g. when switching to a new connection
+    void reset() {
+        readOffset = 0;
+        writeOffset = 0;
+    }
+
+    // Decodes the next complete packet, if one is buffered
+    bool nextMessage(MarketMessage& message) {
+        if (writeOffset - readOffset < PACKET_SIZE) return false;
+        decodePacket(&storage[readOffset], message);
+        readOffset += PACKET_SIZE;
+        return true;
+    }
+
+    // Decodes up to maxCount buffered packets in one batch; returns how many
+    size_t nextMessages(MarketMessage* messages, size_t maxCount) {
+        size_t count = std::min(maxCount, (writeOffset - readOffset) / PACKET_SIZE);
+        if (count == 0) return 0;
+        decodePackets(&storage[readOffset], count, messages);
+        readOffset += count * PACKET_SIZE;
+        return count;
+    }
+
+    // Performs a single recv() into the free space. Returns the recv() result:
+    // bytes read, 0 when the peer closed, negative on error (errno is kept).
+    int fill(SocketHandle socketHandle) {
+        compact();
+        int bytesReceived = recv(socketHandle,
+                                 reinterpret_cast<char*>(&storage[writeOffset]),
+                                 static_cast<int>(storage.size() - writeOffset),
+                                 0);
+        ++receiveCalls;
+        if (bytesReceived > 0) writeOffset += static_cast<size_t>(bytesReceived);
+        return bytesReceived;
+    }
+
+    // Copies in bytes that arrived by another route (io_uring provided
+    // buffers). Returns false, adding nothing, when they do not fit.
+    bool append(const uint8_t* bytes, size_t length) {
+        compact();
+        if (storage.size() - writeOffset < length) return false;
+        memcpy(&storage[writeOffset], bytes, length);
+        writeOffset += length;
+        return true;
+    }
+
+    size_t pendingBytes() const { return writeOffset - readOffset; }
+    size_t receiveCallCount() const { return receiveCalls; }
+
+private:
+    // Moves the unconsumed tail (normally a partial packet) to the front
+    void compact() {
+        size_t pending = writeOffset - readOffset;
+        if (readOffset == 0) return;
+        if (pending > 0) memmove(&storage[0], &storage[readOffset], pending);
+        readOffset = 0;
+        writeOffset = pending;
+    }
+};
+
+#endif // ABX_RECEIVE_BUFFER_H
@@ -0,0 +1,134 @@
+#ifndef ABX_RECOVERY_BACKLOG_H
+#define ABX_RECOVERY_BACKLOG_H
+
+#include "wire_protocol.h"
+
+#include <algorithm>
+#include <deque>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+// Sequence ranges still to be requested from the server, shared by every
+// recovery connection of a session. Connections carve requests off the
+// front and hand back whatever their connection left unanswered; a
+// sequence is abandoned once it has been charged maxAttempts failed
+// connections, or maxExpiries requests that a live connection ignored.
+// Not synchronized: callers that share it between threads hold a lock.
+class RecoveryBacklog {
+private:
+    std::deque<SequenceRange> pendingRanges;
+    std::unordered_map<int32_t, int> failedAttempts;
+    std::unordered_map<int32_t, int> expiredRequests;
+    std::vector<SequenceRange> givenUpRanges;   // abandoned or unaddressable, not yet collected
+    int maxAttempts;
+    int maxExpiries;
+    int unaddressableCount;
+    int abandonedCount;
+    int requeuedCount;
+
+public:
+    RecoveryBacklog(int maxAttemptsPerSequence, int maxExpiriesPerSequence)
+        : maxAttempts(maxAttemptsPerSequence), maxExpiries(maxExpiriesPerSequence),
+          unaddressableCount(0), abandonedCount(0), requeuedCount(0) {}
+
+    void add(const SequenceRange& range) { pendingRanges.push_back(range); }
+
+    template <typename Iterator>
+    void add(Iterator begin, Iterator end) { pendingRanges.insert(pendingRanges.end(), begin, end); }
+
+    bool empty() const { return pendingRanges.empty(); }
+
+    // Appends resend commands for up to limit sequences to commands and
+    // records each requested sequence in inFlight. Returns how many were
+    // requested; each request's range is also appended to requestRanges
+    // when given. With the legacy encoding, sequences above
+    // LEGACY_MAX_SEQUENCE are never sent, since a truncated sequence number
+    // would fetch the wrong packet; they are counted as unaddressable.
+    int32_t takeRequests(uint8_t protocolVersion, int32_t limit,
+                         std::vector<uint8_t>& commands, std::set<int>& inFlight,
+                         std::vector<SequenceRange>* requestRanges = NULL) {
+        int32_t requested = 0;
+        while (!pendingRanges.empty() && requested < limit) {
+            SequenceRange& gap = pendingRanges.front();
+            int32_t count = std::min(gap.count, limit - requested);
+            if (protocolVersion == PROTOCOL_VERSION_LEGACY) {
+                if (gap.start > LEGACY_MAX_SEQUENCE) {
+                    unaddressableCount += gap.count;
+                    givenUpRanges.push_back(gap);
+                    pendingRanges.pop_front();
+                    continue;
+                }
+                count = std::min(count, LEGACY_MAX_SEQUENCE - gap.start + 1);
+            }
+
+            SequenceRange request = { gap.start, count };
+            appendResendRequest(commands, protocolVersion, request);
+            if (requestRanges) requestRanges->push_back(request);
+            for (int32_t seq = request.start; seq < request.start + request.count; ++seq) {
+                inFlight.insert(seq);
+            }
+            requested += count;
+            gap.start += count;
+            gap.count -= count;
+            if (gap.count == 0) pendingRanges.pop_front();
+        }
+        return requested;
+    }
+
+    // Puts the unanswered sequences back, coalesced into ranges. With
+    // chargeAttempt every one of them counts a failed attempt.
+    void requeue(const std::set<int>& unanswered, bool chargeAttempt) {
+        requeue(unanswered, chargeAttempt ? &failedAttempts : NULL, maxAttempts);
+    }
+
+    // Puts back sequences whose request passed its deadline while the
+    // connection kept answering others
+    void requeueExpired(const std::set<int>& expired) {
+        requeue(expired, &expiredRequests, maxExpiries);
+    }
+
+    // Gives up on everything still pending, e.g. when the server is unreachable
+    void abandonAll() {
+        for (size_t i = 0; i < pendingRanges.size(); ++i) abandonedCount += pendingRanges[i].count;
+        givenUpRanges.insert(givenUpRanges.end(), pendingRanges.begin(), pendingRanges.end());
+        pendingRanges.clear();
+    }
+
+    // Moves the ranges given up on since the last call (abandoned or
+    // unaddressable) into ranges, so nothing downstream keeps waiting on them
+    void takeGivenUp(std::vector<SequenceRange>& ranges) {
+        ranges.insert(ranges.end(), givenUpRanges.begin(), givenUpRanges.end());
+        givenUpRanges.clear();
+    }
+
+    int unaddressable() const { return unaddressableCount; }
+    int abandoned() const { return abandonedCount; }
+    int requeued() const { return requeuedCount; }   // sequences put back for another request
+
+private:
+    void requeue(const std::set<int>& unanswered, std::unordered_map<int32_t, int>* charges, int limit) {
+        std::vector<SequenceRange> retryRanges;
+        for (std::set<int>::const_iterator it = unanswered.begin(); it != unanswered.end(); ++it) {
+            if (charges && ++(*charges)[*it] >= limit) {
+                ++abandonedCount;
+                appendCoalesced(givenUpRanges, *it);
+                continue;
+            }
+            ++requeuedCount;
+            appendCoalesced(retryRanges, *it);
+        }
+        add(retryRanges.begin(), retryRanges.end());
+    }
+
+    static void appendCoalesced(std::vector<SequenceRange>& ranges, int32_t seq) {
+        if (!ranges.empty() && ranges.back().start + ranges.back().count == seq) {
+            ranges.back().count++;
+        } else {
+            SequenceRange range = { seq, 1 };
+            ranges.push_back(range);
+        }
+    }
+};
+
+#endif // ABX_RECOVERY_BACKLOG_H
@@ -0,0 +1,146 @@
+#ifndef ABX_RETRY_SCHEDULER_H
+#define ABX_RETRY_SCHEDULER_H
+
+#include "wire_protocol.h"
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <random>
+#include <set>
+#include <vector>
+
+// Pacing for resend requests. None of these classes add delay while the
+// server keeps answering: backoff only starts after a failed connection,
+// and the token bucket is unlimited unless a rate is configured.
+
+// Token bucket over requested sequences, to stay inside a server's resend
+// quota. Refills at ratePerSecond up to burst tokens; a rate of 0 disables
+// the limit. Not synchronized: callers that share one hold a lock.
+class TokenBucket {
+private:
+    double ratePerSecond;
+    double burst;
+    double tokens;
+    std::chrono::steady_clock::time_point refilledAt;
+
+public:
+    explicit TokenBucket(double requestsPerSecond = 0, double burstSize = 1)
+        : ratePerSecond(requestsPerSecond), burst(std::max(1.0, burstSize)), tokens(burst),
+          refilledAt(std::chrono::steady_clock::now()) {}
+
+    bool limited() const { return ratePerSecond > 0; }
+
+    // Whole tokens available now, at most wanted
+    int32_t available(int32_t wanted, std::chrono::steady_clock::time_point now) {
+        if (!limited()) return wanted;
+        refill(now);
+        return std::min(wanted, static_cast<int32_t>(tokens));
+    }
+
+    void consume(int32_t count) {
+        if (limited()) tokens -= count;
+    }
+
+    // When the next whole token will be available
+    std::chrono::steady_clock::time_point nextTokenAt(std::chrono::steady_clock::time_point now) {
+        if (!limited()) return now;
+        refill(now);
+        if (tokens >= 1) return now;
+        return now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>((1 - tokens) / ratePerSecond));
+    }
+
+private:
+    void refill(std::chrono::steady_clock::time_point now) {
+        double elapsed = std::chrono::duration<double>(now - refilledAt).count();
+        tokens = std::min(burst, tokens + elapsed * ratePerSecond);
+        refilledAt = now;
+    }
+};
+
+// Exponential backoff with full jitter for one connection: after the n-th
+// consecutive failure the next attempt waits a uniformly random time in
+// [0, min(maxMs, baseMs * 2^(n-1))]. A success resets it, so a healthy
+// server never waits.
+class RetryBackoff {
+private:
+    int baseMs;
+    int maxMs;
+    int consecutiveFailures;
+    std::chrono::steady_clock::time_point resumeAt;
+    std::minstd_rand random;
+
+public:
+    RetryBackoff(int baseDelayMs, int maxDelayMs, unsigned seed)
+        : baseMs(baseDelayMs), maxMs(maxDelayMs), consecutiveFailures(0),
+          resumeAt(std::chrono::steady_clock::now()), random(seed) {}
+
+    void recordSuccess() { consecutiveFailures = 0; }
+
+    void recordFailure(std::chrono::steady_clock::time_point now) {
+        int shift = std::min(consecutiveFailures++, 20);
+        long long ceiling = std::min<long long>(maxMs, static_cast<long long>(baseMs) << shift);
+        std::uniform_int_distribution<long long> jitter(0, ceiling);
+        resumeAt = now + std::chrono::milliseconds(jitter(random));
+    }
+
+    // The earliest time the next connection attempt may start
+    std::chrono::steady_clock::time_point nextAttemptAt() const { return resumeAt; }
+};
+
+// Per-request deadlines for one connection. Requests are tracked in send
+// order, so the earliest deadline is always at the front; ranges whose
+// sequences have all been answered are dropped as they reach the front.
+class RequestDeadlines {
+private:
+    struct TrackedRequest {
+        std::chrono::steady_clock::time_point deadline;
+        SequenceRange range;
+    };
+    std::deque<TrackedRequest> requests;
+
+public:
+    void track(const std::vector<SequenceRange>& ranges, std::chrono::steady_clock::time_point deadline) {
+        for (size_t i = 0; i < ranges.size(); ++i) {
+            TrackedRequest request = { deadline, ranges[i] };
+            requests.push_back(request);
+        }
+    }
+
+    // Moves sequences whose deadline has passed from inFlight to expired.
+    // Returns how many expired.
+    size_t collectExpired(std::chrono::steady_clock::time_point now,
+                          std::set<int>& inFlight, std::set<int>& expired) {
+        size_t count = 0;
+        while (!requests.empty() && requests.front().deadline <= now) {
+            const SequenceRange& range = requests.front().range;
+            for (int32_t seq = range.start; seq < range.start + range.count; ++seq) {
+                if (inFlight.erase(seq)) {
+                    expired.insert(seq);
+                    ++count;
+                }
+            }
+            requests.pop_front();
+        }
+        return count;
+    }
+
+    // Earliest deadline of a request that still has sequences in flight
+    bool nextDeadline(const std::set<int>& inFlight, std::chrono::steady_clock::time_point& deadline) {
+        while (!requests.empty()) {
+            const SequenceRange& range = requests.front().range;
+            std::set<int>::const_iterator first = inFlight.lower_bound(range.start);
+            if (first != inFlight.end() && *first < range.start + range.count) {
+                deadline = requests.front().deadline;
+                return true;
+            }
+            requests.pop_front();
+        }
+        return false;
+    }
+
+    void clear() { requests.clear(); }
+};
+
+#endif // ABX_RETRY_SCHEDULER_H
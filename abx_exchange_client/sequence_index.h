@@ -0,0 +1,178 @@
+#ifndef ABX_SEQUENCE_INDEX_H
+#define ABX_SEQUENCE_INDEX_H
+
+#include "wire_protocol.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#ifdef _MSC_VER
+    #include <intrin.h>
+#endif
+
+// Index of the lowest set bit in a non-zero word
+inline int lowestSetBit(uint64_t word) {
+    #ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64(&index, word);
+        return static_cast<int>(index);
+    #else
+        return __builtin_ctzll(word);
+    #endif
+}
+
+// Presence index for sequence numbers that arrive mostly in order.
+// Sequences are split into fixed-size pages of one bit each. A page is only
+// allocated once a sequence in it arrives, and is released again as soon
+// as every bit in it is set, so long contiguous runs cost no memory at all.
+class SequenceIndex {
+public:
+    static const int32_t PAGE_SEQUENCES = 1 << 16;
+    static const int32_t WORDS_PER_PAGE = PAGE_SEQUENCES / 64;
+
+private:
+    struct Page {
+        std::unique_ptr<uint64_t[]> words;   // null when the page is empty or full
+        int32_t presentCount;
+
+        Page() : presentCount(0) {}
+    };
+
+    std::vector<Page> pages;
+    int32_t highestSequence;
+    int64_t presentTotal;
+
+public:
+    SequenceIndex() : highestSequence(0), presentTotal(0) {}
+
+    // Marks seq as present. Returns false if it already was (or is not a
+    // valid sequence number).
+    bool insert(int32_t seq) {
+        if (seq <= 0) return false;
+        size_t pageIndex = static_cast<size_t>(seq / PAGE_SEQUENCES);
+        if (pageIndex >= pages.size()) pages.resize(pageIndex + 1);
+
+        Page& page = pages[pageIndex];
+        if (page.presentCount == PAGE_SEQUENCES) return false;
+        if (!page.words) {
+            page.words.reset(new uint64_t[WORDS_PER_PAGE]());
+            if (pageIndex == 0) {
+                // Sequence 0 is never sent; mark it so the first page can fill up
+                page.words[0] = 1;
+                page.presentCount = 1;
+            }
+        }
+
+        int32_t offset = seq % PAGE_SEQUENCES;
+        uint64_t& word = page.words[offset >> 6];
+        uint64_t bit = uint64_t(1) << (offset & 63);
+        int32_t added = static_cast<int32_t>((~word & bit) >> (offset & 63));
+        word |= bit;
+        page.presentCount += added;
+        presentTotal += added;
+        highestSequence = std::max(highestSequence, seq);
+
+        if (page.presentCount == PAGE_SEQUENCES) page.words.reset();
+        return added != 0;
+    }
+
+    bool contains(int32_t seq) const {
+        if (seq <= 0) return false;
+        size_t pageIndex = static_cast<size_t>(seq / PAGE_SEQUENCES);
+        if (pageIndex >= pages.size()) return false;
+
+        const Page& page = pages[pageIndex];
+        if (page.presentCount == PAGE_SEQUENCES) return true;
+        if (!page.words) return false;
+        int32_t offset = seq % PAGE_SEQUENCES;
+        return (page.words[offset >> 6] >> (offset & 63)) & 1;
+    }
+
+    int32_t highest() const { return highestSequence; }
+    int64_t size() const { return presentTotal; }
+
+    // Lowest missing sequence number; highest() + 1 when nothing is missing
+    int32_t firstGap() const {
+        int32_t result = highestSequence + 1;
+        forEachGap([&result](const SequenceRange& gap) {
+            result = gap.start;
+            return false;
+        });
+        return result;
+    }
+
+    // Calls visit(SequenceRange) for each run of missing sequences in
+    // [1, highest()], in ascending order. The visitor returns false to stop.
+    template <typename Visitor>
+    void forEachGap(Visitor visit) const {
+        int32_t runStart = 0;   // 0 while not inside a gap
+        for (size_t pageIndex = 0; pageIndex < pages.size(); ++pageIndex) {
+            const Page& page = pages[pageIndex];
+            int32_t pageBase = static_cast<int32_t>(pageIndex) * PAGE_SEQUENCES;
+
+            if (page.presentCount == PAGE_SEQUENCES) {
+                if (runStart && !emitGap(visit, runStart, pageBase)) return;
+                runStart = 0;
+                continue;
+            }
+            if (!page.words) {
+                if (!runStart) runStart = std::max(pageBase, 1);
+                continue;
+            }
+
+            for (int32_t w = 0; w < WORDS_PER_PAGE; ++w) {
+                uint64_t present = page.words[w];
+                int32_t wordBase = pageBase + w * 64;
+                if (present == ~uint64_t(0)) {
+                    if (runStart && !emitGap(visit, runStart, wordBase)) return;
+                    runStart = 0;
+                    continue;
+                }
+                if (present == 0) {
+                    if (!runStart) runStart = wordBase;
+                    continue;
+                }
+                // Walk the transitions between present and missing bits
+                int bit = 0;
+                while (bit < 64) {
+                    uint64_t remaining = present >> bit;
+                    if (runStart) {
+                        if (remaining == 0) break;
+                        int next = bit + lowestSetBit(remaining);
+                        if (!emitGap(visit, runStart, wordBase + next)) return;
+                        runStart = 0;
+                        bit = next;
+                    } else {
+                        uint64_t missing = ~present >> bit;
+                        if (missing == 0) break;
+                        bit += lowestSetBit(missing);
+                        runStart = wordBase + bit;
+                    }
+                }
+            }
+        }
+        if (runStart && runStart <= highestSequence) emitGap(visit, runStart, highestSequence + 1);
+    }
+
+    // Approximate heap footprint, for comparison against other indexes
+    size_t memoryBytes() const {
+        size_t bytes = pages.capacity() * sizeof(Page);
+        for (size_t i = 0; i < pages.size(); ++i) {
+            if (pages[i].words) bytes += WORDS_PER_PAGE * sizeof(uint64_t);
+        }
+        return bytes;
+    }
+
+private:
+    // Reports [start, end) clipped to the highest sequence seen
+    template <typename Visitor>
+    bool emitGap(Visitor& visit, int32_t start, int32_t end) const {
+        end = std::min(end, highestSequence + 1);
+        if (start >= end) return true;
+        SequenceRange gap = { start, end - start };
+        return visit(gap);
+    }
+};
+
+#endif // ABX_SEQUENCE_INDEX_H
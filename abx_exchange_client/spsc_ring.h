@@ -0,0 +1,80 @@
+#ifndef ABX_SPSC_RING_H
+#define ABX_SPSC_RING_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+const size_t CACHE_LINE_SIZE = 64;
+
+// Bounded lock-free ring for exactly one producer thread and one consumer
+// thread. Each side owns one index and keeps a private copy of the other
+// side's, re-reading the shared one only when the copy says the ring is
+// full (producer) or empty (consumer), so a steady stream costs one
+// release store per batch on each side. The indices sit on separate cache
+// lines to keep the two threads from invalidating each other.
+template <typename T>
+class SpscRing {
+private:
+    std::unique_ptr<T[]> slots;
+    const size_t capacity;   // power of two
+
+    char padBefore[CACHE_LINE_SIZE];
+    std::atomic<size_t> writeIndex;   // written by the producer
+    size_t cachedReadIndex;           // producer's copy of readIndex
+    char padBetween[CACHE_LINE_SIZE];
+    std::atomic<size_t> readIndex;    // written by the consumer
+    size_t cachedWriteIndex;          // consumer's copy of writeIndex
+    char padAfter[CACHE_LINE_SIZE];
+
+public:
+    // requestedCapacity is rounded up to a power of two
+    explicit SpscRing(size_t requestedCapacity)
+        : slots(new T[roundUp(requestedCapacity)]), capacity(roundUp(requestedCapacity)),
+          writeIndex(0), cachedReadIndex(0), readIndex(0), cachedWriteIndex(0) {}
+
+    // Producer: copies up to count items in; returns how many fit
+    size_t pushBatch(const T* items, size_t count) {
+        size_t write = writeIndex.load(std::memory_order_relaxed);
+        size_t space = capacity - (write - cachedReadIndex);
+        if (space < count) {
+            cachedReadIndex = readIndex.load(std::memory_order_acquire);
+            space = capacity - (write - cachedReadIndex);
+        }
+        count = std::min(count, space);
+        for (size_t i = 0; i < count; ++i) slots[(write + i) & (capacity - 1)] = items[i];
+        if (count > 0) writeIndex.store(write + count, std::memory_order_release);
+        return count;
+    }
+
+    // Consumer: moves up to maxCount items out; returns how many
+    size_t popBatch(T* items, size_t maxCount) {
+        size_t read = readIndex.load(std::memory_order_relaxed);
+        size_t available = cachedWriteIndex - read;
+        if (available < maxCount) {
+            cachedWriteIndex = writeIndex.load(std::memory_order_acquire);
+            available = cachedWriteIndex - read;
+        }
+        size_t count = std::min(maxCount, available);
+        for (size_t i = 0; i < count; ++i) items[i] = slots[(read + i) & (capacity - 1)];
+        if (count > 0) readIndex.store(read + count, std::memory_order_release);
+        return count;
+    }
+
+    // Approximate from either side; exact once the producer has stopped
+    size_t size() const {
+        return writeIndex.load(std::memory_order_acquire) - readIndex.load(std::memory_order_acquire);
+    }
+
+    size_t maxSize() const { return capacity; }
+
+private:
+    static size_t roundUp(size_t value) {
+        size_t power = 1;
+        while (power < value) power <<= 1;
+        return power;
+    }
+};
+
+#endif // ABX_SPSC_RING_H
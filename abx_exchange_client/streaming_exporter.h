@@ -0,0 +1,167 @@
+#ifndef ABX_STREAMING_EXPORTER_H
+#define ABX_STREAMING_EXPORTER_H
+
+#include "wire_protocol.h"
+#include "json_writer.h"
+#include "columnar_file.h"
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+const size_t INITIAL_REORDER_CAPACITY = 1024;
+
+// Writes output.json while the session is still running. Each record is
+// written as soon as every lower sequence has been written; records that
+// arrive ahead of a gap wait in a ring indexed by sequence number until the
+// gap is filled, so memory is bounded by the widest open gap rather than by
+// the session length. A gap that will never be filled (recovery gave up on
+// it) is passed over with skip(), releasing what waited behind it. The most recent record is held back until the next
+// one (or finish()) decides whether it needs a trailing comma, which keeps
+// the file byte-identical to the batch export.
+class StreamingExporter {
+private:
+    JsonWriter writer;
+    ColumnarWriter* columnarWriter;   // also receives every record in order, when set
+    int32_t nextSequence;
+    std::vector<MarketMessage> reorderSlots;
+    std::vector<uint8_t> slotFilled;
+    std::map<int32_t, int32_t> skippedRanges;   // first sequence -> one past the last
+    size_t heldCount;
+    size_t peakHeldCount;
+    size_t writtenCount;
+    MarketMessage previous;
+    bool hasPrevious;
+
+public:
+    StreamingExporter()
+        : columnarWriter(NULL), nextSequence(1),
+          reorderSlots(INITIAL_REORDER_CAPACITY), slotFilled(INITIAL_REORDER_CAPACITY, 0),
+          heldCount(0), peakHeldCount(0), writtenCount(0), hasPrevious(false) {}
+
+    bool open(const char* path) {
+        if (!writer.open(path)) return false;
+        writer.beginArray();
+        return true;
+    }
+
+    // Sends every record to a columnar export as well, in the same order
+    void alsoWriteTo(ColumnarWriter* columnar) { columnarWriter = columnar; }
+
+    // Accepts a message in any order. Returns false for a duplicate or an
+    // invalid sequence number.
+    bool add(const MarketMessage& message) {
+        int32_t seq = message.sequenceNum;
+        if (seq < nextSequence || seq <= 0) return false;
+
+        size_t distance = static_cast<size_t>(seq - nextSequence);
+        if (distance >= reorderSlots.size()) grow(distance + 1);
+
+        size_t slot = static_cast<size_t>(seq) & (reorderSlots.size() - 1);
+        if (slotFilled[slot]) return false;
+
+        if (seq == nextSequence) {
+            emit(message);
+            ++nextSequence;
+            drainContiguous();
+        } else {
+            reorderSlots[slot] = message;
+            slotFilled[slot] = 1;
+            ++heldCount;
+            if (heldCount > peakHeldCount) peakHeldCount = heldCount;
+        }
+        return true;
+    }
+
+    // Stops waiting for sequences [first, first + count): records held
+    // behind them are written out. A skipped sequence that still arrives
+    // before the export reaches it is written as usual.
+    void skip(int32_t first, int32_t count) {
+        int32_t end = first + count;
+        first = std::max(first, nextSequence);
+        if (first >= end) return;
+        int32_t& skippedEnd = skippedRanges[first];
+        skippedEnd = std::max(skippedEnd, end);
+        drainContiguous();
+    }
+
+    // Writes out records still waiting behind gaps that were never filled,
+    // then closes the array and the file
+    bool finish() {
+        while (heldCount > 0) {
+            size_t slot = static_cast<size_t>(nextSequence) & (reorderSlots.size() - 1);
+            if (slotFilled[slot]) {
+                slotFilled[slot] = 0;
+                --heldCount;
+                emit(reorderSlots[slot]);
+            }
+            ++nextSequence;
+        }
+        skippedRanges.clear();
+        if (hasPrevious) writer.writeMessage(previous, true);
+        hasPrevious = false;
+        return writer.endArray() && writer.close();
+    }
+
+    size_t recordCount() const { return writtenCount + heldCount; }
+    size_t held() const { return heldCount; }
+    size_t peakHeld() const { return peakHeldCount; }
+    size_t bytesWritten() const { return writer.bytesWritten(); }
+    int32_t contiguousThrough() const { return nextSequence - 1; }
+
+private:
+    void emit(const MarketMessage& message) {
+        if (hasPrevious) writer.writeMessage(previous, false);
+        if (columnarWriter) columnarWriter->write(message);
+        previous = message;
+        hasPrevious = true;
+        ++writtenCount;
+    }
+
+    // Emits held records from nextSequence on, stepping over skipped
+    // sequences, until the next one is still outstanding
+    void drainContiguous() {
+        for (;;) {
+            size_t slot = static_cast<size_t>(nextSequence) & (reorderSlots.size() - 1);
+            if (slotFilled[slot]) {
+                slotFilled[slot] = 0;
+                --heldCount;
+                emit(reorderSlots[slot]);
+            } else if (!skipping()) {
+                return;
+            }
+            ++nextSequence;
+        }
+    }
+
+    // True when nextSequence lies in a skipped range; drops ranges passed
+    bool skipping() {
+        while (!skippedRanges.empty()) {
+            std::map<int32_t, int32_t>::iterator range = skippedRanges.begin();
+            if (range->first > nextSequence) return false;
+            if (nextSequence < range->second) return true;
+            skippedRanges.erase(range);
+        }
+        return false;
+    }
+
+    // Doubles the ring until it spans the requested distance, re-slotting
+    // the held records under the new mask
+    void grow(size_t requiredSpan) {
+        size_t capacity = reorderSlots.size();
+        while (capacity < requiredSpan) capacity *= 2;
+
+        std::vector<MarketMessage> slots(capacity);
+        std::vector<uint8_t> filled(capacity, 0);
+        for (size_t i = 0; i < reorderSlots.size(); ++i) {
+            if (!slotFilled[i]) continue;
+            int32_t seq = reorderSlots[i].sequenceNum;
+            slots[static_cast<size_t>(seq) & (capacity - 1)] = reorderSlots[i];
+            filled[static_cast<size_t>(seq) & (capacity - 1)] = 1;
+        }
+        reorderSlots.swap(slots);
+        slotFilled.swap(filled);
+    }
+};
+
+#endif // ABX_STREAMING_EXPORTER_H
@@ -0,0 +1,103 @@
+#ifndef ABX_SYMBOL_AGGREGATOR_H
+#define ABX_SYMBOL_AGGREGATOR_H
+
+#include "wire_protocol.h"
+#include "symbol_table.h"
+
+#include <algorithm>
+#include <fstream>
+#include <vector>
+
+const size_t EXPECTED_SYMBOL_COUNT = 1024;
+
+// Running totals for one symbol
+struct SymbolTotals {
+    char assetCode[5];
+    uint64_t messageCount;
+    int64_t volume;         // sum of size
+    int64_t notional;       // sum of size * cost
+    int64_t buyVolume;      // size on 'B' messages
+    int64_t sellVolume;     // size on 'S' messages
+
+    double vwap() const { return volume ? static_cast<double>(notional) / volume : 0.0; }
+
+    // (buy - sell) / (buy + sell), from -1 (all selling) to 1 (all buying)
+    double imbalance() const {
+        int64_t sided = buyVolume + sellVolume;
+        return sided ? static_cast<double>(buyVolume - sellVolume) / sided : 0.0;
+    }
+};
+
+// Per-symbol volume, notional/VWAP and buy/sell pressure, updated as each
+// message is accepted. An update is one SymbolTable lookup plus a few adds
+// on the symbol's slot; memory is only allocated when a new symbol appears.
+// When the caller has already interned the asset code (ColumnarStore does),
+// it passes that id and table in and the aggregator's own table stays empty.
+class SymbolAggregator {
+private:
+    SymbolTable symbolTable;
+    std::vector<SymbolTotals> totalsById;   // index 0 is unused (SymbolTable::NO_SYMBOL)
+
+public:
+    SymbolAggregator() : totalsById(1, SymbolTotals()) {
+        totalsById.reserve(EXPECTED_SYMBOL_COUNT + 1);
+    }
+
+    void update(const MarketMessage& message) {
+        update(message, symbolTable.intern(message.assetCode), symbolTable);
+    }
+
+    // Update for a message whose code is already interned as id in symbols.
+    // Every message of a session must use the same table.
+    void update(const MarketMessage& message, uint32_t id, const SymbolTable& symbols) {
+        while (id >= totalsById.size()) {
+            SymbolTotals fresh = SymbolTotals();
+            symbols.copyCode(static_cast<uint32_t>(totalsById.size()), fresh.assetCode);
+            totalsById.push_back(fresh);
+        }
+
+        SymbolTotals& totals = totalsById[id];
+        int64_t size = message.size;
+        totals.messageCount++;
+        totals.volume += size;
+        totals.notional += size * message.cost;
+        if (message.orderDirection == 'B') totals.buyVolume += size;
+        else if (message.orderDirection == 'S') totals.sellVolume += size;
+    }
+
+    size_t symbolCount() const { return totalsById.size() - 1; }
+
+    // Copy of every symbol's totals, highest volume first
+    std::vector<SymbolTotals> snapshot() const {
+        std::vector<SymbolTotals> result(totalsById.begin() + 1, totalsById.end());
+        std::sort(result.begin(), result.end(), [](const SymbolTotals& a, const SymbolTotals& b) {
+            return a.volume != b.volume ? a.volume > b.volume : memcmp(a.assetCode, b.assetCode, 4) < 0;
+        });
+        return result;
+    }
+
+    // Writes the snapshot as a JSON array, one object per symbol
+    bool exportToJSON(const char* path) const {
+        std::ofstream outFile(path);
+        if (!outFile) return false;
+        std::vector<SymbolTotals> totals = snapshot();
+        outFile << "[\n";
+        for (size_t i = 0; i < totals.size(); ++i) {
+            const SymbolTotals& symbol = totals[i];
+            outFile << "    {\n";
+            outFile << "        \"assetCode\": \"" << symbol.assetCode << "\",\n";
+            outFile << "        \"messages\": " << symbol.messageCount << ",\n";
+            outFile << "        \"volume\": " << symbol.volume << ",\n";
+            outFile << "        \"notional\": " << symbol.notional << ",\n";
+            outFile << "        \"vwap\": " << symbol.vwap() << ",\n";
+            outFile << "        \"buyVolume\": " << symbol.buyVolume << ",\n";
+            outFile << "        \"sellVolume\": " << symbol.sellVolume << ",\n";
+            outFile << "        \"imbalance\": " << symbol.imbalance() << "\n";
+            outFile << "    }" << (i + 1 == totals.size() ? "\n" : ",\n");
+        }
+        outFile << "]" << std::endl;
+        return static_cast<bool>(outFile);
+    }
+};
+
+#endif // ABX_SYMBOL_AGGREGATOR_H
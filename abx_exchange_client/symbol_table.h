@@ -0,0 +1,96 @@
+#ifndef ABX_SYMBOL_TABLE_H
+#define ABX_SYMBOL_TABLE_H
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Interns 4-byte asset codes as dense ids 1..size(); 0 means "no symbol".
+// The four wire bytes are read as one uint32_t key and looked up in an
+// open-addressing table with linear probing, so no strings are built or
+// compared. copyCode() maps an id back to its code for export.
+class SymbolTable {
+public:
+    static const uint32_t NO_SYMBOL = 0;
+
+private:
+    struct Slot {
+        uint32_t key;
+        uint32_t id;   // NO_SYMBOL marks an empty slot, so every key value is usable
+    };
+
+    static const size_t INITIAL_CAPACITY = 256;   // power of two, kept at most half full
+
+    std::vector<Slot> slots;
+    std::vector<uint32_t> keysById;   // keysById[id] is the key interned as id
+    int shift;                        // 32 - log2(capacity), for the multiplicative hash
+
+public:
+    SymbolTable() : slots(INITIAL_CAPACITY), keysById(1, 0), shift(32 - 8) {}
+
+    static uint32_t keyFor(const char* code) {
+        uint32_t key;
+        memcpy(&key, code, 4);
+        return key;
+    }
+
+    // Id for the code, assigning the next one if it is new
+    uint32_t intern(const char* code) {
+        uint32_t key = keyFor(code);
+        size_t mask = slots.size() - 1;
+        for (size_t index = hash(key); ; index = (index + 1) & mask) {
+            Slot& slot = slots[index];
+            if (slot.id == NO_SYMBOL) {
+                slot.key = key;
+                slot.id = static_cast<uint32_t>(keysById.size());
+                keysById.push_back(key);
+                if (keysById.size() * 2 > slots.size()) grow();
+                return static_cast<uint32_t>(keysById.size() - 1);
+            }
+            if (slot.key == key) return slot.id;
+        }
+    }
+
+    // Id for the code, or NO_SYMBOL if it was never interned
+    uint32_t find(const char* code) const {
+        uint32_t key = keyFor(code);
+        size_t mask = slots.size() - 1;
+        for (size_t index = hash(key); ; index = (index + 1) & mask) {
+            const Slot& slot = slots[index];
+            if (slot.id == NO_SYMBOL) return NO_SYMBOL;
+            if (slot.key == key) return slot.id;
+        }
+    }
+
+    // Writes the 4 code bytes for id into code, which is left unterminated
+    void copyCode(uint32_t id, char* code) const {
+        memcpy(code, &keysById[id], 4);
+    }
+
+    // Number of interned symbols; ids run from 1 to size()
+    size_t size() const { return keysById.size() - 1; }
+
+    size_t memoryBytes() const {
+        return slots.capacity() * sizeof(Slot) + keysById.capacity() * sizeof(uint32_t);
+    }
+
+private:
+    size_t hash(uint32_t key) const {
+        return static_cast<size_t>((key * 2654435761u) >> shift);
+    }
+
+    void grow() {
+        std::vector<Slot> previous(slots.size() * 2);
+        previous.swap(slots);
+        --shift;
+        size_t mask = slots.size() - 1;
+        for (size_t i = 0; i < previous.size(); ++i) {
+            if (previous[i].id == NO_SYMBOL) continue;
+            size_t index = hash(previous[i].key);
+            while (slots[index].id != NO_SYMBOL) index = (index + 1) & mask;
+            slots[index] = previous[i];
+        }
+    }
+};
+
+#endif // ABX_SYMBOL_TABLE_H
@@ -0,0 +1,313 @@
+#ifndef ABX_URING_RECEIVER_H
+#define ABX_URING_RECEIVER_H
+
+#include "platform.h"
+#include "receive_buffer.h"
+
+#include <cstddef>
+#include <cstring>
+
+#if defined(__linux__) && defined(__has_include)
+    #if __has_include(<linux/io_uring.h>)
+        #define ABX_URING_AVAILABLE 1
+    #endif
+#endif
+
+#ifdef ABX_URING_AVAILABLE
+    #include <linux/io_uring.h>
+    #include <signal.h>
+    #include <sys/mman.h>
+    #include <sys/syscall.h>
+    #include <time.h>
+#endif
+
+const unsigned URING_CQ_ENTRIES = 256;
+const unsigned URING_BUFFER_COUNT = 64;            // power of two, as the buffer ring requires
+const unsigned URING_BUFFER_SIZE = 16 * 1024;      // must fit in an emptied ReceiveBuffer
+const unsigned URING_BUFFER_GROUP = 0;
+
+// Linux io_uring receive path for one socket. start() arms a single
+// multishot recv that picks its destination from a registered ring of
+// provided buffers, so the kernel keeps filling buffers as data arrives and
+// posts one completion per chunk; fill() copies completed chunks into the
+// connection's ReceiveBuffer and hands the buffers straight back. A
+// syscall is only needed to sleep when no completion is pending, instead
+// of one recv() per read.
+//
+// Requires kernel 6.0 or later (multishot recv). start() returns false and
+// leaves the caller on plain recv() when the kernel, the headers or a
+// seccomp policy rule it out. Talks to the kernel through the raw syscalls,
+// so liburing is not needed.
+class UringReceiver {
+#ifdef ABX_URING_AVAILABLE
+private:
+    int ringHandle;
+    SocketHandle socketHandle;
+    void* ringMemory;
+    size_t ringMemorySize;
+    struct io_uring_sqe* submissionEntries;
+    size_t submissionEntriesSize;
+
+    unsigned* sqHead;
+    unsigned* sqTail;
+    unsigned* sqMask;
+    unsigned* sqArray;
+    unsigned* cqHead;
+    unsigned* cqTail;
+    unsigned* cqMask;
+    struct io_uring_cqe* completions;
+
+    // The buffer ring is addressed as a plain io_uring_buf array: under C++
+    // the header's flexible-array wrapper moves bufs[] off offset 0. The
+    // ring tail overlays the resv field of the first slot.
+    struct io_uring_buf* bufferRing;
+    uint16_t* bufferTail;
+    size_t bufferRingSize;
+    uint8_t* buffers;
+    bool armed;
+    bool peerClosed;
+    int startError;
+    size_t enterCalls;
+
+public:
+    UringReceiver()
+        : ringHandle(-1), socketHandle(-1), ringMemory(MAP_FAILED), ringMemorySize(0),
+          submissionEntries(static_cast<struct io_uring_sqe*>(MAP_FAILED)), submissionEntriesSize(0),
+          sqHead(NULL), sqTail(NULL), sqMask(NULL), sqArray(NULL),
+          cqHead(NULL), cqTail(NULL), cqMask(NULL), completions(NULL),
+          bufferRing(static_cast<struct io_uring_buf*>(MAP_FAILED)), bufferTail(NULL), bufferRingSize(0),
+          buffers(static_cast<uint8_t*>(MAP_FAILED)), armed(false), peerClosed(false),
+          startError(0), enterCalls(0) {}
+
+    UringReceiver(const UringReceiver&) = delete;
+    UringReceiver& operator=(const UringReceiver&) = delete;
+    ~UringReceiver() { stop(); }
+
+    // Sets up the ring and arms the multishot recv on a connected socket
+    bool start(SocketHandle socket) {
+        stop();
+        socketHandle = socket;
+        peerClosed = false;
+        if (!setupRing() || !registerBuffers() || !armReceive()) {
+            startError = errno;
+            stop();
+            return false;
+        }
+        startError = 0;
+        return true;
+    }
+
+    // Tears the ring down, which also cancels the outstanding recv. Call
+    // before closing the socket.
+    void stop() {
+        if (ringHandle >= 0) close(ringHandle);
+        if (ringMemory != MAP_FAILED) munmap(ringMemory, ringMemorySize);
+        if (submissionEntries != MAP_FAILED) munmap(submissionEntries, submissionEntriesSize);
+        if (bufferRing != MAP_FAILED) munmap(bufferRing, bufferRingSize);
+        if (buffers != MAP_FAILED) munmap(buffers, size_t(URING_BUFFER_COUNT) * URING_BUFFER_SIZE);
+        ringHandle = -1;
+        ringMemory = MAP_FAILED;
+        submissionEntries = static_cast<struct io_uring_sqe*>(MAP_FAILED);
+        bufferRing = static_cast<struct io_uring_buf*>(MAP_FAILED);
+        buffers = static_cast<uint8_t*>(MAP_FAILED);
+        armed = false;
+    }
+
+    bool active() const { return ringHandle >= 0; }
+
+    // The ring descriptor becomes readable when completions are posted, so
+    // an EventLoop watches it in place of the socket
+    SocketHandle handle() const { return ringHandle; }
+
+    // errno of the last failed start()
+    int lastStartError() const { return startError; }
+
+    // io_uring_enter() calls made so far, arming included
+    size_t enterCallCount() const { return enterCalls; }
+
+    // Moves completed data into the receive buffer. Same contract as
+    // ReceiveBuffer::fill(): bytes added, 0 once the peer has closed, or -1
+    // with errno set. With wait false, or once timeoutMs (if positive)
+    // expires, an empty completion queue gives EAGAIN.
+    int fill(ReceiveBuffer& buffer, bool wait, int timeoutMs) {
+        for (;;) {
+            int added = reapCompletions(buffer);
+            if (added != 0) return added;
+            if (peerClosed) return 0;
+            if (!armed && !armReceive()) return -1;
+            if (!wait) {
+                errno = EAGAIN;
+                return -1;
+            }
+            if (!waitForCompletion(timeoutMs)) {
+                if (errno == ETIME) errno = EAGAIN;
+                return -1;
+            }
+        }
+    }
+
+private:
+    int enter(unsigned toSubmit, unsigned minComplete, unsigned flags, const void* argument, size_t argumentSize) {
+        ++enterCalls;
+        return static_cast<int>(syscall(__NR_io_uring_enter, ringHandle, toSubmit, minComplete,
+                                        flags, argument, argumentSize));
+    }
+
+    bool setupRing() {
+        struct io_uring_params params;
+        memset(&params, 0, sizeof(params));
+        params.flags = IORING_SETUP_CQSIZE;
+        params.cq_entries = URING_CQ_ENTRIES;
+        ringHandle = static_cast<int>(syscall(__NR_io_uring_setup, 4, &params));
+        if (ringHandle < 0) return false;
+
+        // Kernels without these features predate multishot recv anyway
+        if (!(params.features & IORING_FEAT_SINGLE_MMAP) || !(params.features & IORING_FEAT_EXT_ARG)) {
+            errno = ENOSYS;
+            return false;
+        }
+
+        size_t sqSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        size_t cqSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+        ringMemorySize = sqSize > cqSize ? sqSize : cqSize;
+        ringMemory = mmap(NULL, ringMemorySize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                          ringHandle, IORING_OFF_SQ_RING);
+        if (ringMemory == MAP_FAILED) return false;
+
+        submissionEntriesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+        submissionEntries = static_cast<struct io_uring_sqe*>(
+            mmap(NULL, submissionEntriesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                 ringHandle, IORING_OFF_SQES));
+        if (submissionEntries == MAP_FAILED) return false;
+
+        uint8_t* ring = static_cast<uint8_t*>(ringMemory);
+        sqHead = reinterpret_cast<unsigned*>(ring + params.sq_off.head);
+        sqTail = reinterpret_cast<unsigned*>(ring + params.sq_off.tail);
+        sqMask = reinterpret_cast<unsigned*>(ring + params.sq_off.ring_mask);
+        sqArray = reinterpret_cast<unsigned*>(ring + params.sq_off.array);
+        cqHead = reinterpret_cast<unsigned*>(ring + params.cq_off.head);
+        cqTail = reinterpret_cast<unsigned*>(ring + params.cq_off.tail);
+        cqMask = reinterpret_cast<unsigned*>(ring + params.cq_off.ring_mask);
+        completions = reinterpret_cast<struct io_uring_cqe*>(ring + params.cq_off.cqes);
+        return true;
+    }
+
+    bool registerBuffers() {
+        bufferRingSize = URING_BUFFER_COUNT * sizeof(struct io_uring_buf);
+        bufferRing = static_cast<struct io_uring_buf*>(
+            mmap(NULL, bufferRingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+        if (bufferRing == MAP_FAILED) return false;
+        bufferTail = &bufferRing[0].resv;
+        buffers = static_cast<uint8_t*>(
+            mmap(NULL, size_t(URING_BUFFER_COUNT) * URING_BUFFER_SIZE, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+        if (buffers == MAP_FAILED) return false;
+
+        struct io_uring_buf_reg registration;
+        memset(&registration, 0, sizeof(registration));
+        registration.ring_addr = reinterpret_cast<uint64_t>(bufferRing);
+        registration.ring_entries = URING_BUFFER_COUNT;
+        registration.bgid = URING_BUFFER_GROUP;
+        if (syscall(__NR_io_uring_register, ringHandle, IORING_REGISTER_PBUF_RING, &registration, 1) < 0) {
+            return false;
+        }
+
+        for (unsigned id = 0; id < URING_BUFFER_COUNT; ++id) provideBuffer(static_cast<uint16_t>(id), id);
+        __atomic_store_n(bufferTail, static_cast<uint16_t>(URING_BUFFER_COUNT), __ATOMIC_RELEASE);
+        return true;
+    }
+
+    // Writes buffer id into ring slot 'slot'; the caller publishes the tail
+    void provideBuffer(uint16_t id, unsigned slot) {
+        struct io_uring_buf& entry = bufferRing[slot & (URING_BUFFER_COUNT - 1)];
+        entry.addr = reinterpret_cast<uint64_t>(buffers + size_t(id) * URING_BUFFER_SIZE);
+        entry.len = URING_BUFFER_SIZE;
+        entry.bid = id;
+    }
+
+    void recycleBuffer(uint16_t id) {
+        uint16_t tail = *bufferTail;
+        provideBuffer(id, tail);
+        __atomic_store_n(bufferTail, static_cast<uint16_t>(tail + 1), __ATOMIC_RELEASE);
+    }
+
+    // Queues the multishot recv. It stays armed until the socket closes,
+    // fails, or the kernel runs out of provided buffers.
+    bool armReceive() {
+        unsigned tail = *sqTail;
+        unsigned index = tail & *sqMask;
+        struct io_uring_sqe& entry = submissionEntries[index];
+        memset(&entry, 0, sizeof(entry));
+        entry.opcode = IORING_OP_RECV;
+        entry.fd = socketHandle;
+        entry.flags = IOSQE_BUFFER_SELECT;
+        entry.buf_group = URING_BUFFER_GROUP;
+        entry.ioprio = IORING_RECV_MULTISHOT;
+        sqArray[index] = index;
+        __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+
+        if (enter(1, 0, 0, NULL, 0) != 1) return false;
+        armed = true;
+        return true;
+    }
+
+    // Consumes completions while their data fits into the receive buffer.
+    // Returns bytes added, or -1 with errno set when the recv failed.
+    int reapCompletions(ReceiveBuffer& buffer) {
+        unsigned head = *cqHead;
+        unsigned tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+        int added = 0, error = 0;
+
+        while (head != tail && !peerClosed && error == 0) {
+            const struct io_uring_cqe& completion = completions[head & *cqMask];
+            if (completion.res > 0) {
+                uint16_t id = static_cast<uint16_t>(completion.flags >> IORING_CQE_BUFFER_SHIFT);
+                if (!buffer.append(buffers + size_t(id) * URING_BUFFER_SIZE, static_cast<size_t>(completion.res))) {
+                    break;   // no room until the caller decodes what is buffered
+                }
+                added += completion.res;
+                recycleBuffer(id);
+            } else if (completion.res == 0) {
+                peerClosed = true;
+            } else if (completion.res != -ENOBUFS) {
+                error = -completion.res;   // ENOBUFS only means the recv must be re-armed
+            }
+            if (!(completion.flags & IORING_CQE_F_MORE)) armed = false;
+            ++head;
+        }
+        __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+
+        if (added > 0) return added;
+        if (error != 0) {
+            errno = error;
+            return -1;
+        }
+        return 0;
+    }
+
+    bool waitForCompletion(int timeoutMs) {
+        struct __kernel_timespec timeout;
+        timeout.tv_sec = timeoutMs / 1000;
+        timeout.tv_nsec = (timeoutMs % 1000) * 1000000LL;
+        struct io_uring_getevents_arg argument;
+        memset(&argument, 0, sizeof(argument));
+        argument.sigmask_sz = _NSIG / 8;
+        if (timeoutMs > 0) argument.ts = reinterpret_cast<uint64_t>(&timeout);
+        return enter(0, 1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &argument, sizeof(argument)) >= 0;
+    }
+#else
+public:
+    bool start(SocketHandle) { return false; }
+    void stop() {}
+    bool active() const { return false; }
+    SocketHandle handle() const { return SocketHandle(); }
+    int lastStartError() const { return ENOSYS; }
+    size_t enterCallCount() const { return 0; }
+    int fill(ReceiveBuffer&, bool, int) {
+        errno = ENOSYS;
+        return -1;
+    }
+#endif
+};
+
+#endif // ABX_URING_RECEIVER_H
@@ -0,0 +1,49 @@
+#ifndef ABX_UTILITIES_H
+#define ABX_UTILITIES_H
+
+#include "platform.h"
+
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// Enums for error types
+enum class NetworkErrorType {
+    SOCKET_CREATION,
+    CONNECTION,
+    DATA_RECEPTION
+};
+
+// Utility Functions
+namespace Utilities {
+    inline void printError(NetworkErrorType type, int errorCode = 0) {
+        switch (type) {
+            case NetworkErrorType::SOCKET_CREATION:
+                std::cerr << "Socket creation error: " << errorCode << std::endl;
+                break;
+            case NetworkErrorType::CONNECTION:
+                std::cerr << "Connection failed: " << errorCode << std::endl;
+                break;
+            case NetworkErrorType::DATA_RECEPTION:
+                std::cerr << "Data reception error: " << errorCode << std::endl;
+                break;
+        }
+    }
+
+    inline bool stdoutIsTerminal() {
+        #ifdef _WIN32
+            return _isatty(_fileno(stdout)) != 0;
+        #else
+            return isatty(fileno(stdout)) != 0;
+        #endif
+    }
+
+    inline std::string generateErrorMessage(const std::string& context, int errorCode) {
+        std::stringstream ss;
+        ss << context << " Error Code: " << errorCode;
+        return ss.str();
+    }
+}
+
+#endif // ABX_UTILITIES_H
@@ -0,0 +1,131 @@
+#ifndef ABX_WIRE_PROTOCOL_H
+#define ABX_WIRE_PROTOCOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Every packet sent by the exchange is exactly this many bytes
+const size_t PACKET_SIZE = 17;
+
+// Enums for commands
+enum class CommandType : uint8_t {
+    INITIAL_STREAM = 1,
+    SPECIFIC_SEQUENCE = 2,
+    RESEND_RANGE = 3,       // v2: [3][version][start:u32][count:u32]
+    PROTOCOL_HELLO = 0x7F   // v2: [0x7F][version], answered by a handshake packet
+};
+
+// Command encodings understood by the client
+const uint8_t PROTOCOL_VERSION_LEGACY = 1;   // 2-byte commands, 8-bit sequence numbers
+const uint8_t PROTOCOL_VERSION_RANGES = 2;   // 32-bit sequence ranges
+const int32_t LEGACY_MAX_SEQUENCE = 255;
+const size_t RANGE_COMMAND_SIZE = 10;
+
+// A v2 server answers PROTOCOL_HELLO with a packet carrying this asset code,
+// sequenceNum 0 and the accepted protocol version in the size field
+const char HANDSHAKE_ASSET_CODE[] = "ABXP";
+
+// Contiguous run of sequence numbers [start, start + count)
+struct SequenceRange {
+    int32_t start;
+    int32_t count;
+};
+
+// Data structure for message format
+struct MarketMessage {
+    char assetCode[5];
+    char orderDirection;
+    int32_t size;
+    int32_t cost;
+    int32_t sequenceNum;
+};
+
+// Reads a big-endian int32 without assuming the source is aligned
+inline int32_t readInt32BE(const uint8_t* bytes) {
+    return static_cast<int32_t>(
+        (static_cast<uint32_t>(bytes[0]) << 24) |
+        (static_cast<uint32_t>(bytes[1]) << 16) |
+        (static_cast<uint32_t>(bytes[2]) << 8) |
+        static_cast<uint32_t>(bytes[3]));
+}
+
+inline void writeInt32BE(uint8_t* bytes, int32_t value) {
+    uint32_t bits = static_cast<uint32_t>(value);
+    bytes[0] = static_cast<uint8_t>(bits >> 24);
+    bytes[1] = static_cast<uint8_t>(bits >> 16);
+    bytes[2] = static_cast<uint8_t>(bits >> 8);
+    bytes[3] = static_cast<uint8_t>(bits);
+}
+
+// Little-endian counterparts, used by the client's own file formats
+inline void writeUInt32LE(uint8_t* bytes, uint32_t value) {
+    for (int i = 0; i < 4; ++i) bytes[i] = static_cast<uint8_t>(value >> (8 * i));
+}
+
+inline void writeUInt64LE(uint8_t* bytes, uint64_t value) {
+    for (int i = 0; i < 8; ++i) bytes[i] = static_cast<uint8_t>(value >> (8 * i));
+}
+
+inline uint32_t readUInt32LE(const uint8_t* bytes) {
+    uint32_t value = 0;
+    for (int i = 3; i >= 0; --i) value = (value << 8) | bytes[i];
+    return value;
+}
+
+inline uint64_t readUInt64LE(const uint8_t* bytes) {
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; --i) value = (value << 8) | bytes[i];
+    return value;
+}
+
+// Parses one 17-byte wire packet into a MarketMessage
+inline void decodePacket(const uint8_t* packet, MarketMessage& message) {
+    memcpy(message.assetCode, packet, 4);
+    message.assetCode[4] = '\0';
+    message.orderDirection = static_cast<char>(packet[4]);
+    message.size = readInt32BE(packet + 5);
+    message.cost = readInt32BE(packet + 9);
+    message.sequenceNum = readInt32BE(packet + 13);
+}
+
+// Serializes a message into one 17-byte wire packet
+inline void encodePacket(const MarketMessage& message, uint8_t* packet) {
+    memcpy(packet, message.assetCode, 4);
+    packet[4] = static_cast<uint8_t>(message.orderDirection);
+    writeInt32BE(packet + 5, message.size);
+    writeInt32BE(packet + 9, message.cost);
+    writeInt32BE(packet + 13, message.sequenceNum);
+}
+
+inline bool isHandshakePacket(const MarketMessage& message) {
+    return message.sequenceNum == 0 &&
+           memcmp(message.assetCode, HANDSHAKE_ASSET_CODE, 4) == 0;
+}
+
+// Appends a plain 2-byte command
+inline void appendCommand(std::vector<uint8_t>& buffer, CommandType commandCode, uint8_t param = 0) {
+    buffer.push_back(static_cast<uint8_t>(commandCode));
+    buffer.push_back(param);
+}
+
+// Appends the request(s) asking for [range.start, range.start + range.count)
+// in the given protocol version. Legacy commands carry one 8-bit sequence
+// each, so callers must keep legacy ranges within LEGACY_MAX_SEQUENCE.
+inline void appendResendRequest(std::vector<uint8_t>& buffer, uint8_t version, const SequenceRange& range) {
+    if (version >= PROTOCOL_VERSION_RANGES) {
+        size_t offset = buffer.size();
+        buffer.resize(offset + RANGE_COMMAND_SIZE);
+        buffer[offset] = static_cast<uint8_t>(CommandType::RESEND_RANGE);
+        buffer[offset + 1] = PROTOCOL_VERSION_RANGES;
+        writeInt32BE(&buffer[offset + 2], range.start);
+        writeInt32BE(&buffer[offset + 6], range.count);
+        return;
+    }
+    for (int32_t seq = range.start; seq < range.start + range.count; ++seq) {
+        appendCommand(buffer, CommandType::SPECIFIC_SEQUENCE, static_cast<uint8_t>(seq));
+    }
+}
+
+#endif // ABX_WIRE_PROTOCOL_H
@@ -0,0 +1,337 @@
+#ifndef ABX_MOCK_EXCHANGE_H
+#define ABX_MOCK_EXCHANGE_H
+
+#include "../abx_exchange_client/platform.h"
+#include "../abx_exchange_client/wire_protocol.h"
+
+#include <algorithm>
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+const int MOCK_DEFAULT_PORT = 3000;
+const int32_t MOCK_DEFAULT_PACKETS = 1000000;
+const int MOCK_DEFAULT_SYMBOLS = 64;
+const size_t MOCK_SEND_BATCH_PACKETS = 4096;
+
+// Knobs for the generated session. Rates are probabilities per packet.
+struct MockExchangeConfig {
+    int port;                 // 0 picks a free port, see MockExchangeServer::port()
+    int32_t packetCount;      // sequences 1..packetCount exist
+    int symbolCount;
+    double dropRate;          // packets left out of the initial stream
+    double reorderRate;       // packets swapped with their successor in the stream
+    double duplicateRate;     // packets sent twice in the stream
+    double resendDropRate;    // resend requests silently ignored
+    uint64_t seed;
+    bool legacyOnly;          // behave like the original server: no PROTOCOL_HELLO / RESEND_RANGE
+
+    MockExchangeConfig()
+        : port(MOCK_DEFAULT_PORT), packetCount(MOCK_DEFAULT_PACKETS), symbolCount(MOCK_DEFAULT_SYMBOLS),
+          dropRate(0.01), reorderRate(0.0), duplicateRate(0.0), resendDropRate(0.0),
+          seed(1), legacyOnly(false) {}
+};
+
+// Loopback exchange that speaks the client protocol: 2-byte commands (plus
+// the v2 handshake and 10-byte range requests) in, 17-byte packets out.
+// Packet contents and the drop/reorder/duplicate decisions are pure
+// functions of the sequence number and seed, so nothing is stored and any
+// packet can be re-sent on request. Every connection gets its own thread.
+class MockExchangeServer {
+private:
+    MockExchangeConfig config;
+    SocketHandle listenSocket;
+    int boundPort;
+    std::atomic<bool> running;
+    std::thread acceptThread;
+    struct ConnectionWorker {
+        std::thread thread;
+        std::shared_ptr<std::atomic<bool> > finished;
+    };
+
+    std::mutex connectionsMutex;
+    std::list<ConnectionWorker> connectionWorkers;
+    std::set<SocketHandle> openSockets;
+
+    std::atomic<uint64_t> streamedPackets;
+    std::atomic<uint64_t> droppedPackets;
+    std::atomic<uint64_t> resentPackets;
+    std::atomic<uint64_t> resendRequests;
+
+public:
+    explicit MockExchangeServer(const MockExchangeConfig& exchangeConfig = MockExchangeConfig())
+        : config(exchangeConfig), boundPort(0), running(false),
+          streamedPackets(0), droppedPackets(0), resentPackets(0), resendRequests(0) {}
+
+    ~MockExchangeServer() { stop(); }
+
+    bool start() {
+        listenSocket = socket(AF_INET, SOCK_STREAM, 0);
+        int reuse = 1;
+        setsockopt(listenSocket, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+
+        struct sockaddr_in address;
+        memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast<uint16_t>(config.port));
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (bind(listenSocket, (struct sockaddr*)&address, sizeof(address)) < 0 ||
+            listen(listenSocket, 64) < 0) {
+            closeSocket(listenSocket);
+            return false;
+        }
+
+        socklen_t length = sizeof(address);
+        getsockname(listenSocket, (struct sockaddr*)&address, &length);
+        boundPort = ntohs(address.sin_port);
+
+        running.store(true);
+        acceptThread = std::thread(&MockExchangeServer::acceptLoop, this);
+        return true;
+    }
+
+    void stop() {
+        if (!running.exchange(false)) return;
+        shutdownSocket(listenSocket);
+        closeSocket(listenSocket);
+        acceptThread.join();
+
+        std::list<ConnectionWorker> workers;
+        {
+            std::lock_guard<std::mutex> lock(connectionsMutex);
+            for (std::set<SocketHandle>::iterator it = openSockets.begin(); it != openSockets.end(); ++it) {
+                shutdownSocket(*it);
+            }
+            workers.swap(connectionWorkers);
+        }
+        for (std::list<ConnectionWorker>::iterator it = workers.begin(); it != workers.end(); ++it) {
+            it->thread.join();
+        }
+    }
+
+    int port() const { return boundPort; }
+    const MockExchangeConfig& settings() const { return config; }
+    uint64_t streamed() const { return streamedPackets.load(); }
+    uint64_t dropped() const { return droppedPackets.load(); }
+    uint64_t resent() const { return resentPackets.load(); }
+
+    // Deterministic packet content for a sequence number
+    MarketMessage messageFor(int32_t seq) const {
+        MarketMessage message;
+        uint64_t bits = mix(static_cast<uint64_t>(seq) * 4 + 0);
+        int symbol = static_cast<int>(static_cast<uint32_t>(seq) % static_cast<uint32_t>(config.symbolCount));
+        for (int i = 3; i >= 0; --i) {
+            message.assetCode[i] = static_cast<char>('A' + symbol % 26);
+            symbol /= 26;
+        }
+        message.assetCode[4] = '\0';
+        message.orderDirection = (bits & 1) ? 'B' : 'S';
+        message.size = static_cast<int32_t>((bits >> 8) % 1000 + 1);
+        message.cost = static_cast<int32_t>((bits >> 24) % 100000 + 100);
+        message.sequenceNum = seq;
+        return message;
+    }
+
+    bool isDropped(int32_t seq) const { return chance(seq, 1, config.dropRate); }
+    bool isReordered(int32_t seq) const { return chance(seq, 2, config.reorderRate); }
+    bool isDuplicated(int32_t seq) const { return chance(seq, 3, config.duplicateRate); }
+
+private:
+    static void closeSocket(SocketHandle handle) {
+        #ifdef _WIN32
+            closesocket(handle);
+        #else
+            close(handle);
+        #endif
+    }
+
+    static void shutdownSocket(SocketHandle handle) {
+        #ifdef _WIN32
+            shutdown(handle, SD_BOTH);
+        #else
+            shutdown(handle, SHUT_RDWR);
+        #endif
+    }
+
+    // splitmix64 finalizer over (seed, key)
+    uint64_t mix(uint64_t key) const {
+        uint64_t z = key + config.seed * 0x9E3779B97F4A7C15ULL;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    bool chance(int32_t seq, int salt, double rate) const {
+        if (rate <= 0.0) return false;
+        uint64_t bits = mix(static_cast<uint64_t>(seq) * 4 + salt);
+        return (bits >> 11) * (1.0 / 9007199254740992.0) < rate;
+    }
+
+    void acceptLoop() {
+        while (running.load()) {
+            SocketHandle client = accept(listenSocket, NULL, NULL);
+            #ifdef _WIN32
+                if (client == INVALID_SOCKET) continue;
+            #else
+                if (client < 0) continue;
+            #endif
+            std::lock_guard<std::mutex> lock(connectionsMutex);
+            if (!running.load()) {
+                closeSocket(client);
+                break;
+            }
+            reapFinishedWorkers();
+            openSockets.insert(client);
+
+            ConnectionWorker worker;
+            worker.finished = std::make_shared<std::atomic<bool> >(false);
+            worker.thread = std::thread(&MockExchangeServer::serveConnection, this, client, worker.finished);
+            connectionWorkers.push_back(std::move(worker));
+        }
+    }
+
+    // Joins connection threads that have already returned; callers hold connectionsMutex
+    void reapFinishedWorkers() {
+        std::list<ConnectionWorker>::iterator it = connectionWorkers.begin();
+        while (it != connectionWorkers.end()) {
+            if (it->finished->load()) {
+                it->thread.join();
+                it = connectionWorkers.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    void serveConnection(SocketHandle client, std::shared_ptr<std::atomic<bool> > finished) {
+        std::vector<uint8_t> commands;
+        std::vector<uint8_t> replies;
+        uint8_t chunk[4096];
+        bool open = true;
+
+        while (open) {
+            int bytesReceived = recv(client, reinterpret_cast<char*>(chunk), sizeof(chunk), 0);
+            if (bytesReceived <= 0) break;
+            commands.insert(commands.end(), chunk, chunk + bytesReceived);
+
+            size_t offset = 0;
+            while (open && commands.size() - offset >= 2) {
+                uint8_t type = commands[offset];
+                if (type == static_cast<uint8_t>(CommandType::RESEND_RANGE) && !config.legacyOnly) {
+                    if (commands.size() - offset < RANGE_COMMAND_SIZE) break;
+                    int64_t start = readInt32BE(&commands[offset + 2]);
+                    int64_t count = readInt32BE(&commands[offset + 6]);
+                    offset += RANGE_COMMAND_SIZE;
+                    // Clamped to sequences that exist, so a bogus range cannot overflow or flood the replies
+                    int64_t first = std::max<int64_t>(start, 1);
+                    int64_t end = std::min<int64_t>(start + count, static_cast<int64_t>(config.packetCount) + 1);
+                    for (int64_t seq = first; seq < end; ++seq) appendResend(replies, static_cast<int32_t>(seq));
+                    continue;
+                }
+
+                uint8_t param = commands[offset + 1];
+                offset += 2;
+                if (type == static_cast<uint8_t>(CommandType::INITIAL_STREAM)) {
+                    if (!sendAll(client, replies)) open = false;
+                    replies.clear();
+                    if (open) streamSession(client);
+                    open = false;   // the exchange closes the connection after a full stream
+                } else if (type == static_cast<uint8_t>(CommandType::SPECIFIC_SEQUENCE)) {
+                    appendResend(replies, param);
+                } else if (type == static_cast<uint8_t>(CommandType::PROTOCOL_HELLO) && !config.legacyOnly) {
+                    MarketMessage handshake;
+                    memset(&handshake, 0, sizeof(handshake));
+                    memcpy(handshake.assetCode, HANDSHAKE_ASSET_CODE, 4);
+                    handshake.size = PROTOCOL_VERSION_RANGES;
+                    appendPacket(replies, handshake);
+                }
+            }
+            commands.erase(commands.begin(), commands.begin() + offset);
+
+            if (open && !replies.empty()) {
+                open = sendAll(client, replies);
+                replies.clear();
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(connectionsMutex);
+            openSockets.erase(client);
+        }
+        closeSocket(client);
+        finished->store(true);
+    }
+
+    // Streams 1..packetCount with the configured drops, swaps and duplicates
+    void streamSession(SocketHandle client) {
+        std::vector<uint8_t> batch;
+        batch.reserve((MOCK_SEND_BATCH_PACKETS + 2) * PACKET_SIZE);
+        bool holding = false;
+        MarketMessage held;
+
+        for (int32_t seq = 1; seq <= config.packetCount && running.load(); ++seq) {
+            if (isDropped(seq)) {
+                droppedPackets.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            MarketMessage message = messageFor(seq);
+            if (!holding && isReordered(seq) && seq < config.packetCount) {
+                held = message;
+                holding = true;
+                continue;
+            }
+            appendStreamPacket(batch, message);
+            if (holding) {
+                appendStreamPacket(batch, held);
+                holding = false;
+            }
+            if (batch.size() >= MOCK_SEND_BATCH_PACKETS * PACKET_SIZE) {
+                if (!sendAll(client, batch)) return;
+                batch.clear();
+            }
+        }
+        if (holding) appendStreamPacket(batch, held);
+        sendAll(client, batch);
+        shutdownSocket(client);
+    }
+
+    void appendStreamPacket(std::vector<uint8_t>& batch, const MarketMessage& message) {
+        appendPacket(batch, message);
+        streamedPackets.fetch_add(1, std::memory_order_relaxed);
+        if (isDuplicated(message.sequenceNum)) appendPacket(batch, message);
+    }
+
+    void appendResend(std::vector<uint8_t>& replies, int32_t seq) {
+        if (seq < 1 || seq > config.packetCount) return;
+        uint64_t request = resendRequests.fetch_add(1, std::memory_order_relaxed);
+        if (chance(static_cast<int32_t>(request & 0x7FFFFFFF), 0, config.resendDropRate)) return;
+        appendPacket(replies, messageFor(seq));
+        resentPackets.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static void appendPacket(std::vector<uint8_t>& out, const MarketMessage& message) {
+        size_t offset = out.size();
+        out.resize(offset + PACKET_SIZE);
+        encodePacket(message, &out[offset]);
+    }
+
+    static bool sendAll(SocketHandle client, const std::vector<uint8_t>& bytes) {
+        size_t offset = 0;
+        while (offset < bytes.size()) {
+            int sent = send(client, reinterpret_cast<const char*>(&bytes[offset]),
+                            static_cast<int>(bytes.size() - offset), SEND_FLAGS);
+            if (sent < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            offset += static_cast<size_t>(sent);
+        }
+        return true;
+    }
+};
+
+#endif // ABX_MOCK_EXCHANGE_H
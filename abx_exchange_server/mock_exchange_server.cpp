@@ -0,0 +1,72 @@
+// Native mock exchange for local load and loss testing.
+//
+// Build: g++ -std=c++11 -O2 -pthread mock_exchange_server.cpp -o mock_exchange_server
+// Run:   ./mock_exchange_server --packets=10000000 --drop=0.01 --reorder=0.001
+
+#include "mock_exchange.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+static bool readOption(const std::string& arg, const char* name, std::string& value) {
+    std::string prefix = std::string(name) + "=";
+    if (arg.compare(0, prefix.size(), prefix) != 0) return false;
+    value = arg.substr(prefix.size());
+    return true;
+}
+
+static void printUsage() {
+    std::cerr << "Usage: mock_exchange_server [--port=N] [--packets=N] [--symbols=N]\n"
+              << "                            [--drop=RATE] [--reorder=RATE] [--duplicate=RATE]\n"
+              << "                            [--resend-drop=RATE] [--seed=N] [--legacy]" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    MockExchangeConfig config;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i], value;
+        if (readOption(arg, "--port", value)) config.port = atoi(value.c_str());
+        else if (readOption(arg, "--packets", value)) config.packetCount = static_cast<int32_t>(atol(value.c_str()));
+        else if (readOption(arg, "--symbols", value)) config.symbolCount = std::max(1, atoi(value.c_str()));
+        else if (readOption(arg, "--drop", value)) config.dropRate = atof(value.c_str());
+        else if (readOption(arg, "--reorder", value)) config.reorderRate = atof(value.c_str());
+        else if (readOption(arg, "--duplicate", value)) config.duplicateRate = atof(value.c_str());
+        else if (readOption(arg, "--resend-drop", value)) config.resendDropRate = atof(value.c_str());
+        else if (readOption(arg, "--seed", value)) config.seed = strtoull(value.c_str(), NULL, 10);
+        else if (arg == "--legacy") config.legacyOnly = true;
+        else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    #ifdef _WIN32
+        WSADATA wsaData;
+        WSAStartup(MAKEWORD(2, 2), &wsaData);
+    #endif
+
+    MockExchangeServer server(config);
+    if (!server.start()) {
+        std::cerr << "Could not listen on port " << config.port << std::endl;
+        return 1;
+    }
+
+    std::cout << "TCP server started on port " << server.port() << std::endl;
+    std::cout << config.packetCount << " packets over " << config.symbolCount << " symbols"
+              << " (drop " << config.dropRate << ", reorder " << config.reorderRate
+              << ", duplicate " << config.duplicateRate << ", resend drop " << config.resendDropRate
+              << (config.legacyOnly ? ", legacy protocol" : "") << ")" << std::endl;
+
+    // Serve until interrupted, reporting counters whenever they change
+    uint64_t lastStreamed = 0, lastResent = 0;
+    for (;;) {
+        delay_milliseconds(1000);
+        if (server.streamed() == lastStreamed && server.resent() == lastResent) continue;
+        lastStreamed = server.streamed();
+        lastResent = server.resent();
+        std::cout << "streamed " << lastStreamed << "  dropped " << server.dropped()
+                  << "  resent " << lastResent << std::endl;
+    }
+}